@@ -0,0 +1,284 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+#include "recorder.h"
+#include "grid_memory.h"
+#include "engine_factory.h"
+#include "checkpoint.h"
+#include "net_protocol.h"
+
+// Settings that can be given on the command line
+struct AppOptions
+{
+    int rows = 200;
+    int cols = 200;
+    GridMemoryConfig memory;
+    std::string engineName = "scalar";
+    std::string crossCheckEngine; // Empty = no cross-check
+    EngineConfig engine;
+    std::string loadPath; // Grid file to load on launch, e.g. a checkpoint
+    CheckpointSettings checkpoint;
+    bool recordOnStart = false;
+    RecordSettings record;
+    std::string serverAddress;  // Non-empty = run headless and serve the simulation here
+    int stepIntervalMs = 100;   // Server time between generations
+    std::string connectAddress; // Non-empty = show a server's simulation instead of running one
+    std::string testClientAddress;
+    Viewport testViewport{0, 0, 64, 64};
+    int testFrames = 100;
+};
+
+inline std::string joinedEngineNames()
+{
+    std::string joined;
+    for (const std::string &name : engineNames())
+        joined += (joined.empty() ? "" : ", ") + name;
+    return joined;
+}
+
+inline void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --rows N                 Number of grid rows (default: 200)\n"
+              << "  --cols N                 Number of grid columns (default: 200)\n"
+              << "  --threads N              Worker threads for stepping large grids (default: 1)\n"
+              << "  --huge-pages             Back large grid buffers with 2 MB huge pages\n"
+              << "  --memory-budget MB       Refuse grid allocations beyond this many megabytes\n"
+              << "  --engine NAME            Simulation engine: " << joinedEngineNames() << " (default: scalar)\n"
+              << "  --cross-check NAME       Run this engine in lockstep with --engine and report the first divergence\n"
+              << "  --sparse-threshold F     Live fraction above which the sparse engine switches to a dense kernel (default: 0.01)\n"
+              << "  --load FILE              Load a grid file (e.g. a checkpoint) on launch and resume at its generation\n"
+              << "  --checkpoint FILE        Periodically save the running grid to FILE\n"
+              << "  --checkpoint-every N     Generations between checkpoints (default: 1000)\n"
+              << "  --record BASE            Start recording frames on launch (output name without extension)\n"
+              << "  --record-format FORMAT   png (numbered sequence), apng or y4m (default: png)\n"
+              << "  --record-scope SCOPE     board (one pixel per cell) or viewport (default: board)\n"
+              << "  --record-every N         Capture every Nth generation (default: 1)\n"
+              << "  --record-policy POLICY   drop or block when the encoder falls behind (default: drop)\n"
+              << "  --record-queue N         Frames buffered for the encoder (default: 8)\n"
+              << "  --record-fps N           Playback rate of apng and y4m output (default: 10)\n"
+              << "  --server ADDRESS         Run headless and serve the simulation on unix:PATH or tcp:[HOST:]PORT\n"
+              << "                           (tcp:PORT is loopback only; use tcp:0.0.0.0:PORT to accept other machines)\n"
+              << "  --step-interval MS       Milliseconds between server generations, 0 = as fast as possible (default: 100)\n"
+              << "  --connect ADDRESS        View a server's simulation (unix:PATH or tcp:HOST:PORT)\n"
+              << "  --test-client ADDRESS    Connect without a window and print the frames received\n"
+              << "  --test-viewport T,L,H,W  Cells the test client subscribes to (default: 0,0,64,64)\n"
+              << "  --test-frames N          Frames the test client receives before exiting (default: 100)\n"
+              << "  --help                   Show this help" << std::endl;
+}
+
+// Parses a positive integer option value, reporting an error if it is invalid
+inline bool parsePositiveInt(const std::string &option, const std::string &value, int &result)
+{
+    char *end = nullptr;
+    long parsed = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || parsed <= 0 || parsed > 1000000000L)
+    {
+        std::cerr << "Error: " << option << " expects a positive integer, got '" << value << "'" << std::endl;
+        return false;
+    }
+    result = (int)parsed;
+    return true;
+}
+
+// Returns false if the program should exit (invalid arguments or --help)
+inline bool parseArgs(int argc, char *argv[], AppOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage(argv[0]);
+            return false;
+        }
+        if (arg == "--huge-pages")
+        {
+            options.memory.hugePages = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Error: Unknown option or missing value: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--rows")
+        {
+            if (!parsePositiveInt(arg, value, options.rows))
+                return false;
+        }
+        else if (arg == "--cols")
+        {
+            if (!parsePositiveInt(arg, value, options.cols))
+                return false;
+        }
+        else if (arg == "--threads")
+        {
+            if (!parsePositiveInt(arg, value, options.memory.workerThreads))
+                return false;
+        }
+        else if (arg == "--memory-budget")
+        {
+            int megabytes;
+            if (!parsePositiveInt(arg, value, megabytes))
+                return false;
+            options.memory.budgetBytes = (size_t)megabytes * 1024 * 1024;
+        }
+        else if (arg == "--engine" || arg == "--cross-check")
+        {
+            if (!isEngineName(value))
+            {
+                std::cerr << "Error: Unknown engine: " << value << " (available: " << joinedEngineNames() << ")" << std::endl;
+                return false;
+            }
+            (arg == "--engine" ? options.engineName : options.crossCheckEngine) = value;
+        }
+        else if (arg == "--sparse-threshold")
+        {
+            char *end = nullptr;
+            double threshold = std::strtod(value.c_str(), &end);
+            if (value.empty() || *end != '\0' || !(threshold > 0.0 && threshold <= 1.0))
+            {
+                std::cerr << "Error: --sparse-threshold expects a fraction in (0, 1], got '" << value << "'" << std::endl;
+                return false;
+            }
+            options.engine.sparseDensityThreshold = threshold;
+        }
+        else if (arg == "--load")
+        {
+            options.loadPath = value;
+        }
+        else if (arg == "--checkpoint")
+        {
+            options.checkpoint.path = value;
+        }
+        else if (arg == "--checkpoint-every")
+        {
+            if (!parsePositiveInt(arg, value, options.checkpoint.everyNth))
+                return false;
+        }
+        else if (arg == "--record")
+        {
+            options.recordOnStart = true;
+            options.record.basePath = value;
+        }
+        else if (arg == "--record-format")
+        {
+            if (value == "png")
+                options.record.format = RecordFormat::PNG_SEQUENCE;
+            else if (value == "apng")
+                options.record.format = RecordFormat::APNG;
+            else if (value == "y4m")
+                options.record.format = RecordFormat::Y4M;
+            else
+            {
+                std::cerr << "Error: Unknown record format: " << value << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--record-scope")
+        {
+            if (value == "board")
+                options.record.scope = RecordScope::BOARD;
+            else if (value == "viewport")
+                options.record.scope = RecordScope::VIEWPORT;
+            else
+            {
+                std::cerr << "Error: Unknown record scope: " << value << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--record-policy")
+        {
+            if (value == "drop")
+                options.record.policy = QueuePolicy::DROP;
+            else if (value == "block")
+                options.record.policy = QueuePolicy::BLOCK;
+            else
+            {
+                std::cerr << "Error: Unknown record policy: " << value << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--record-every")
+        {
+            if (!parsePositiveInt(arg, value, options.record.everyNth))
+                return false;
+        }
+        else if (arg == "--record-queue")
+        {
+            if (!parsePositiveInt(arg, value, options.record.queueCapacity))
+                return false;
+        }
+        else if (arg == "--record-fps")
+        {
+            if (!parsePositiveInt(arg, value, options.record.fps))
+                return false;
+            if (options.record.fps > 65535)
+            {
+                std::cerr << "Error: " << arg << " expects a value of at most 65535, got '" << value << "'" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--server")
+        {
+            options.serverAddress = value;
+        }
+        else if (arg == "--step-interval")
+        {
+            char *end = nullptr;
+            long interval = std::strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || interval < 0 || interval > 3600000L)
+            {
+                std::cerr << "Error: --step-interval expects a number of milliseconds, got '" << value << "'" << std::endl;
+                return false;
+            }
+            options.stepIntervalMs = (int)interval;
+        }
+        else if (arg == "--connect")
+        {
+            options.connectAddress = value;
+        }
+        else if (arg == "--test-client")
+        {
+            options.testClientAddress = value;
+        }
+        else if (arg == "--test-viewport")
+        {
+            Viewport &viewport = options.testViewport;
+            char extra;
+            if (std::sscanf(value.c_str(), "%d,%d,%d,%d%c", &viewport.top, &viewport.left, &viewport.height,
+                            &viewport.width, &extra) != 4 ||
+                viewport.top < 0 || viewport.left < 0 || viewport.empty())
+            {
+                std::cerr << "Error: --test-viewport expects TOP,LEFT,HEIGHT,WIDTH, got '" << value << "'" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--test-frames")
+        {
+            if (!parsePositiveInt(arg, value, options.testFrames))
+                return false;
+        }
+        else
+        {
+            std::cerr << "Error: Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    // A viewer has no board of its own to load, checkpoint or record
+    if (!options.connectAddress.empty() &&
+        (!options.loadPath.empty() || !options.checkpoint.path.empty() || options.recordOnStart))
+    {
+        std::cerr << "Error: --load, --checkpoint and --record cannot be used with --connect" << std::endl;
+        return false;
+    }
+    return true;
+}
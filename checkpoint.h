@@ -0,0 +1,113 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include "pre_game.h" // For Grid struct
+#include "life_engine.h"
+#include "file_io.h"
+
+struct CheckpointSettings
+{
+    std::string path;     // Empty = checkpointing disabled
+    int everyNth = 1000;  // Generations between checkpoints
+};
+
+// Periodically saves the running board to a file. This is not a copy-on-write snapshot: at each
+// checkpoint the whole board is exported from the engine on the simulation thread, which takes time
+// proportional to the board area (for the block engine, unpacking every cell) and briefly needs a
+// second board's worth of memory. Only formatting and writing the file then happens on a background
+// GridFileJob while the simulation keeps stepping. Checkpoints go to a temporary file that is
+// renamed over the previous one once complete, so a crash mid-write never destroys the last good
+// checkpoint. The file records the generation, so loading it resumes the count.
+class Checkpointer
+{
+public:
+    Checkpointer() = default;
+    Checkpointer(const Checkpointer &) = delete;
+    Checkpointer &operator=(const Checkpointer &) = delete;
+
+    ~Checkpointer()
+    {
+        // Let a checkpoint in progress finish rather than cancel it
+        while (job.busy())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            poll();
+        }
+    }
+
+    void configure(const CheckpointSettings &newSettings) { settings = newSettings; }
+    bool enabled() const { return !settings.path.empty() && settings.everyNth > 0; }
+
+    long long checkpointsWritten() const { return written; }
+    long long checkpointsSkipped() const { return skipped; }
+
+    // True when the schedule asks for a checkpoint of this generation
+    bool due(long long generation) const
+    {
+        return enabled() && generation != 0 && generation % settings.everyNth == 0;
+    }
+
+    // Called after each generation with the engine holding the board. When a checkpoint is due the
+    // board is exported on the calling thread and the copy is handed to the writer. A checkpoint is
+    // skipped, never fatal, when the previous one is still being written or there is not enough
+    // memory for the copy: the run keeps going and the next one is tried on schedule.
+    void onGeneration(const LifeEngine &engine, long long generation)
+    {
+        if (!due(generation))
+            return;
+        poll();
+        if (busy())
+        {
+            ++skipped;
+            std::cerr << "Checkpoint at generation " << generation << " skipped: previous checkpoint still writing."
+                      << std::endl;
+            return;
+        }
+        try
+        {
+            Grid board{};
+            engine.exportCells(board);
+            pendingGeneration = generation;
+            job.startExport(std::move(board), settings.path, generation);
+        }
+        catch (const std::bad_alloc &)
+        {
+            ++skipped;
+            std::cerr << "Checkpoint at generation " << generation << " skipped: not enough memory to copy the board."
+                      << std::endl;
+        }
+    }
+
+    // Call regularly (e.g. once per frame) to collect finished checkpoints
+    void poll()
+    {
+        Grid unused{};
+        long long unusedGeneration;
+        GridFileJob::Kind kind;
+        GridFileJob::Result result;
+        if (!job.poll(unused, unusedGeneration, kind, result))
+            return;
+        if (result == GridFileJob::Result::SUCCESS)
+        {
+            ++written;
+            std::cout << "Checkpoint of generation " << pendingGeneration << " written to " << settings.path
+                      << std::endl;
+        }
+        else
+        {
+            std::cerr << "Error: Checkpoint of generation " << pendingGeneration << " to " << settings.path
+                      << " failed." << std::endl;
+        }
+    }
+
+    bool busy() const { return job.busy(); }
+
+private:
+    CheckpointSettings settings;
+    GridFileJob job;
+    long long pendingGeneration = 0;
+    long long written = 0;
+    long long skipped = 0;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "life_engine.h"
+#include "block_engine.h"
+#include "sparse_engine.h"
+
+// Names accepted by createEngine, in the order the settings menu cycles through them
+inline std::vector<std::string> engineNames()
+{
+    return {"scalar", "block", "sparse"};
+}
+
+// Returns nullptr for an unknown engine name
+inline std::unique_ptr<LifeEngine> createEngine(const std::string &name)
+{
+    if (name == "scalar")
+        return std::make_unique<ScalarEngine>();
+    if (name == "block")
+        return std::make_unique<BlockEngine>();
+    if (name == "sparse")
+        return std::make_unique<SparseEngine>();
+    return nullptr;
+}
+
+// Creates the named engine, wrapped in a LockstepEngine checking it against crossCheckName if given
+inline std::unique_ptr<LifeEngine> createEngine(const std::string &name, const std::string &crossCheckName)
+{
+    std::unique_ptr<LifeEngine> engine = createEngine(name);
+    if (!engine || crossCheckName.empty())
+        return engine;
+    std::unique_ptr<LifeEngine> shadow = createEngine(crossCheckName);
+    if (!shadow)
+        return nullptr;
+    return std::make_unique<LockstepEngine>(std::move(engine), std::move(shadow));
+}
+
+inline bool isEngineName(const std::string &name)
+{
+    for (const std::string &known : engineNames())
+    {
+        if (known == name)
+            return true;
+    }
+    return false;
+}
+
+// The engine following name in engineNames(), wrapping around
+inline std::string nextEngineName(const std::string &name)
+{
+    std::vector<std::string> names = engineNames();
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (names[i] == name)
+            return names[(i + 1) % names.size()];
+    }
+    return names.front();
+}
@@ -3,61 +3,252 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include <sstream>
+#include <atomic>
+#include <thread>
+#include <cstdio>
 #include "pre_game.h" // For Grid struct
 
-inline bool exportGrid(const Grid& grid, const std::string& filepath) {
-    std::ofstream outFile(filepath);
+const char* const DEFAULT_SAVE_FILE = "grid_save.txt";
+
+// Progress and cancellation state shared between the UI thread and an I/O worker.
+// Progress is counted in grid rows.
+struct IOProgress {
+    std::atomic<long long> done{0};
+    std::atomic<long long> total{0};
+    std::atomic<bool> cancelRequested{false};
+};
+
+inline bool ioCancelled(const IOProgress* progress) {
+    return progress && progress->cancelRequested.load(std::memory_order_relaxed);
+}
+
+// Saves grid as text: a header line "rows cols", followed by the generation the board is at when it
+// is not 0, then one line of space-separated 0/1 cells per row
+inline bool exportGrid(const Grid& grid, const std::string& filepath, IOProgress* progress = nullptr,
+                       long long generation = 0) {
+    // Write to a temporary file first so a failed or cancelled export never clobbers an existing save
+    const std::string tmpPath = filepath + ".tmp";
+    std::ofstream outFile(tmpPath, std::ios::binary);
     if (!outFile.is_open()) {
-        std::cerr << "Error: Could not open file for writing: " << filepath << std::endl;
+        std::cerr << "Error: Could not open file for writing: " << tmpPath << std::endl;
         return false;
     }
+    if (progress) progress->total = grid.rows;
 
-    // Write dimensions first
-    outFile << grid.rows << " " << grid.cols << std::endl;
+    // Write dimensions first, and the generation so a resumed run keeps counting from it
+    outFile << grid.rows << " " << grid.cols;
+    if (generation != 0) outFile << " " << generation;
+    outFile << '\n';
 
-    // Write cell data
+    // Write cell data one formatted row at a time instead of one stream insertion per cell
+    std::string line(grid.cols > 0 ? grid.cols * 2 : 0, ' ');
+    if (!line.empty()) line.back() = '\n';
     for (int i = 0; i < grid.rows; ++i) {
+        if (ioCancelled(progress)) {
+            outFile.close();
+            std::remove(tmpPath.c_str());
+            std::cerr << "Export to " << filepath << " cancelled." << std::endl;
+            return false;
+        }
         for (int j = 0; j < grid.cols; ++j) {
-            outFile << grid.cells[i][j] << (j == grid.cols - 1 ? "" : " ");
+            line[j * 2] = grid.cells[i][j] ? '1' : '0';
         }
-        outFile << std::endl;
+        outFile.write(line.data(), line.size());
+        if (progress) progress->done = i + 1;
     }
     outFile.close();
+    if (outFile.fail()) {
+        std::remove(tmpPath.c_str());
+        std::cerr << "Error: Failed while writing " << filepath << std::endl;
+        return false;
+    }
+
+#ifdef _WIN32
+    std::remove(filepath.c_str()); // rename() does not replace an existing file on Windows
+#endif
+    // Elsewhere rename() replaces the target atomically, so a crash leaves either the old or the new save
+    if (std::rename(tmpPath.c_str(), filepath.c_str()) != 0) {
+        std::cerr << "Error: Could not move " << tmpPath << " to " << filepath << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
     std::cout << "Grid exported successfully to " << filepath << std::endl;
     return true;
 }
 
-inline bool importGrid(Grid& grid, const std::string& filepath) {
-    std::ifstream inFile(filepath);
+// Reads the next whitespace-separated integer token straight from the stream buffer.
+// Returns false at end of file or on a non-numeric token. Only 0 and 1 are valid cells, so any
+// larger value is reported as 2 rather than accumulated (which could overflow on a long digit run).
+inline bool readCellToken(std::streambuf* buf, int& value) {
+    int c = buf->sbumpc();
+    while (c == ' ' || c == '\n' || c == '\r' || c == '\t') c = buf->sbumpc();
+    if (c < '0' || c > '9') return false;
+    value = 0;
+    while (c >= '0' && c <= '9') {
+        if (value <= 1) value = value * 10 + (c - '0');
+        if (value > 1) value = 2;
+        c = buf->sbumpc();
+    }
+    return true;
+}
+
+// Loads a file written by exportGrid(). If generation is given it is set to the generation stored
+// in the file, or 0 for files without one.
+inline bool importGrid(Grid& grid, const std::string& filepath, IOProgress* progress = nullptr,
+                       long long* generation = nullptr) {
+    std::ifstream inFile(filepath, std::ios::binary);
     if (!inFile.is_open()) {
         std::cerr << "Error: Could not open file for reading: " << filepath << std::endl;
         return false;
     }
 
+    std::string header;
+    std::getline(inFile, header);
+    std::istringstream headerStream(header);
     int rows, cols;
-    inFile >> rows >> cols;
-    if (inFile.fail() || rows <= 0 || cols <= 0) {
+    long long savedGeneration = 0;
+    headerStream >> rows >> cols;
+    if (headerStream.fail() || rows <= 0 || cols <= 0) {
         std::cerr << "Error: Invalid file format or dimensions in " << filepath << std::endl;
         return false;
     }
+    if (!(headerStream >> savedGeneration)) savedGeneration = 0; // Saved before the generation was stored
+    if (savedGeneration < 0) {
+        std::cerr << "Error: Invalid generation in " << filepath << std::endl;
+        return false;
+    }
+    if (progress) progress->total = rows;
 
-    // Resize grid and read cell data
-    grid.rows = rows;
-    grid.cols = cols;
-    grid.cells.assign(rows, std::vector<bool>(cols, false));
+    // Read into a separate buffer so the target grid is only replaced once the whole file parsed
+    CellBuffer cells;
+    try {
+        cells.reset(rows, cols);
+    } catch (const std::bad_alloc&) {
+        std::cerr << "Error: Not enough memory for a " << rows << "x" << cols << " grid." << std::endl;
+        return false;
+    }
+    std::streambuf* buf = inFile.rdbuf();
 
     for (int i = 0; i < rows; ++i) {
+        if (ioCancelled(progress)) {
+            std::cerr << "Import from " << filepath << " cancelled." << std::endl;
+            return false;
+        }
         for (int j = 0; j < cols; ++j) {
             int cell_val;
-            inFile >> cell_val;
-            if (inFile.fail()) {
+            if (!readCellToken(buf, cell_val)) {
                 std::cerr << "Error: File format error or unexpected end of file." << std::endl;
                 return false;
             }
-            grid.cells[i][j] = (cell_val == 1);
+            cells[i][j] = (cell_val == 1);
         }
+        if (progress) progress->done = i + 1;
     }
     inFile.close();
+
+    grid.rows = rows;
+    grid.cols = cols;
+    grid.cells = std::move(cells);
+    if (generation) *generation = savedGeneration;
     std::cout << "Grid imported successfully from " << filepath << std::endl;
     return true;
 }
+
+// Runs one import or export at a time on a background thread so the UI never blocks on disk I/O.
+// Exports take ownership of a board exported for them, so the running simulation is never read from
+// the writer thread; imports are handed over by poll() on the UI thread, so the simulation never
+// sees a half-loaded board.
+class GridFileJob {
+public:
+    enum class Kind { NONE, IMPORT, EXPORT };
+    enum class Result { SUCCESS, FAILED, CANCELLED };
+
+    GridFileJob() = default;
+    GridFileJob(const GridFileJob&) = delete;
+    GridFileJob& operator=(const GridFileJob&) = delete;
+
+    ~GridFileJob() {
+        cancel();
+        if (worker.joinable()) worker.join();
+    }
+
+    bool busy() const { return kind != Kind::NONE; }
+    Kind currentKind() const { return kind; }
+
+    // Fraction of rows processed so far, in [0, 1]
+    float fraction() const {
+        long long total = progress.total.load();
+        return total > 0 ? (float)progress.done.load() / (float)total : 0.0f;
+    }
+
+    // generation is stored in the file along with the board
+    bool startExport(Grid&& grid, const std::string& filepath, long long generation = 0) {
+        if (busy()) return false;
+        snapshot = std::move(grid);
+        begin(Kind::EXPORT);
+        worker = std::thread([this, filepath, generation] {
+            succeeded = exportGrid(snapshot, filepath, &progress, generation);
+            finished = true;
+        });
+        return true;
+    }
+
+    bool startImport(const std::string& filepath) {
+        if (busy()) return false;
+        snapshot = Grid{};
+        begin(Kind::IMPORT);
+        worker = std::thread([this, filepath] {
+            succeeded = importGrid(snapshot, filepath, &progress, &snapshotGeneration);
+            finished = true;
+        });
+        return true;
+    }
+
+    void cancel() { progress.cancelRequested = true; }
+
+    // Call once per frame on the UI thread. Returns true when a job has just completed and
+    // reports which kind it was and how it ended. A successful import replaces the cells of
+    // grid here while keeping its camera (cell size and offsets), and sets generation to the one
+    // stored in the file; the caller hands them on to the engine.
+    bool poll(Grid& grid, long long& generation, Kind& completedKind, Result& result) {
+        if (!busy() || !finished) return false;
+        worker.join();
+
+        completedKind = kind;
+        if (succeeded) {
+            result = Result::SUCCESS;
+        } else {
+            result = progress.cancelRequested ? Result::CANCELLED : Result::FAILED;
+        }
+
+        if (kind == Kind::IMPORT && succeeded) {
+            grid.rows = snapshot.rows;
+            grid.cols = snapshot.cols;
+            grid.cells = std::move(snapshot.cells);
+            generation = snapshotGeneration;
+        }
+        snapshot = Grid{};
+        kind = Kind::NONE;
+        return true;
+    }
+
+private:
+    void begin(Kind newKind) {
+        progress.done = 0;
+        progress.total = 0;
+        progress.cancelRequested = false;
+        succeeded = false;
+        finished = false;
+        snapshotGeneration = 0;
+        kind = newKind;
+    }
+
+    Kind kind = Kind::NONE;
+    Grid snapshot{};
+    long long snapshotGeneration = 0;
+    IOProgress progress;
+    std::atomic<bool> finished{false};
+    std::atomic<bool> succeeded{false};
+    std::thread worker;
+};
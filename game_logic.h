@@ -1,46 +1,62 @@
 #pragma once
 #include "pre_game.h"
 
-// Update the grid based on Conway's Game of Life rules
-inline void updateGrid(Grid &grid)
+// Computes rows [beginRow, endRow) of the next generation of cells into next
+inline void updateRows(const CellBuffer &cells, CellBuffer &next, int rows, int cols, int beginRow, int endRow)
 {
-    if (grid.rows == 0 || grid.cols == 0) return;
-
-    std::vector<std::vector<bool>> newCells = grid.cells;
-
-    for (int row = 0; row < grid.rows; ++row)
+    for (int row = beginRow; row < endRow; ++row)
     {
-        for (int col = 0; col < grid.cols; ++col)
+        const uint8_t *above = row > 0 ? cells[row - 1] : nullptr;
+        const uint8_t *current = cells[row];
+        const uint8_t *below = row < rows - 1 ? cells[row + 1] : nullptr;
+        uint8_t *out = next[row];
+
+        for (int col = 0; col < cols; ++col)
         {
             int liveNeighbors = 0;
-            for (int i = -1; i <= 1; ++i)
+            for (int j = -1; j <= 1; ++j)
             {
-                for (int j = -1; j <= 1; ++j)
-                {
-                    if (i == 0 && j == 0) continue;
-
-                    int neighbor_row = row + i;
-                    int neighbor_col = col + j;
-
-                    if (neighbor_row >= 0 && neighbor_row < grid.rows &&
-                        neighbor_col >= 0 && neighbor_col < grid.cols &&
-                        grid.cells[neighbor_row][neighbor_col])
-                    {
-                        liveNeighbors++;
-                    }
-                }
-            }
+                int neighbor_col = col + j;
+                if (neighbor_col < 0 || neighbor_col >= cols)
+                    continue;
 
-            if (grid.cells[row][col] && (liveNeighbors < 2 || liveNeighbors > 3))
-            {
-                newCells[row][col] = false;
-            }
-            else if (!grid.cells[row][col] && liveNeighbors == 3)
-            {
-                newCells[row][col] = true;
+                if (above)
+                    liveNeighbors += above[neighbor_col];
+                if (below)
+                    liveNeighbors += below[neighbor_col];
+                if (j != 0)
+                    liveNeighbors += current[neighbor_col];
             }
+
+            if (current[col])
+                out[col] = (liveNeighbors == 2 || liveNeighbors == 3);
+            else
+                out[col] = (liveNeighbors == 3);
         }
     }
+}
+
+// Update the grid based on Conway's Game of Life rules.
+// next is scratch space for the new generation; keeping it between calls avoids reallocating
+// (and re-faulting) a full grid buffer every generation.
+inline void updateGrid(Grid &grid, CellBuffer &next)
+{
+    if (grid.rows == 0 || grid.cols == 0) return;
+
+    if (next.rows() != grid.rows || next.cols() != grid.cols)
+        next.reset(grid.rows, grid.cols);
 
-    grid.cells = newCells;
+    const CellBuffer &cells = grid.cells;
+    int rows = grid.rows;
+    int cols = grid.cols;
+    forEachRowBand(rows, cells.sizeBytes(), [&](int beginRow, int endRow)
+                   { updateRows(cells, next, rows, cols, beginRow, endRow); });
+
+    grid.cells.swap(next);
+}
+
+inline void updateGrid(Grid &grid)
+{
+    CellBuffer next;
+    updateGrid(grid, next);
 }
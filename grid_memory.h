@@ -0,0 +1,430 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <new>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define GRID_MEMORY_USE_MMAP 1
+#endif
+
+const size_t CACHE_LINE_SIZE = 64;
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+// Below this size a grid is processed by a single thread; handing it to the workers would cost more than it saves
+const size_t PARALLEL_MIN_BYTES = 1 << 20;
+
+// Process-wide settings for grid buffers, set once from the command line
+struct GridMemoryConfig
+{
+    bool hugePages = false; // Back large buffers with 2 MB pages
+    int workerThreads = 1;  // Threads that first-touch and step row bands
+    size_t budgetBytes = 0; // 0 = unlimited
+};
+
+struct GridMemoryStats
+{
+    std::atomic<size_t> bytesInUse{0};
+    std::atomic<size_t> peakBytes{0};
+    std::atomic<size_t> hugePageBytes{0};
+};
+
+inline GridMemoryConfig &gridMemoryConfig()
+{
+    static GridMemoryConfig config;
+    return config;
+}
+
+inline GridMemoryStats &gridMemoryStats()
+{
+    static GridMemoryStats stats;
+    return stats;
+}
+
+// Persistent worker threads for processing a grid in row bands. Worker t always runs band t and,
+// on Linux, is pinned to one CPU, so the thread that first-touches a band when a buffer is cleared
+// or copied is the thread that later steps it, on the same NUMA node.
+class RowBandPool
+{
+public:
+    explicit RowBandPool(int threads) : threadCount(std::max(threads, 1))
+    {
+        for (int t = 0; t < threadCount; ++t)
+            workers.emplace_back([this, t] { workerLoop(t); });
+    }
+
+    RowBandPool(const RowBandPool &) = delete;
+    RowBandPool &operator=(const RowBandPool &) = delete;
+
+    ~RowBandPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    int size() const { return threadCount; }
+
+    // Runs fn(beginRow, endRow) for band t of rows on worker t and waits for all bands to finish
+    void run(int rows, const std::function<void(int, int)> &fn)
+    {
+        std::lock_guard<std::mutex> runLock(runMutex); // One grid operation at a time
+        std::unique_lock<std::mutex> lock(mutex);
+        job = &fn;
+        jobRows = rows;
+        remaining = threadCount;
+        ++jobId;
+        wake.notify_all();
+        done.wait(lock, [this] { return remaining == 0; });
+        job = nullptr;
+    }
+
+    // True on a pool worker, where a nested run() would wait on itself
+    static bool &onWorkerThread()
+    {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+private:
+    void workerLoop(int index)
+    {
+        onWorkerThread() = true;
+        pinToCpu(index);
+        unsigned long long seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            wake.wait(lock, [&] { return stopping || jobId != seen; });
+            if (stopping)
+                return;
+            seen = jobId;
+            const std::function<void(int, int)> *fn = job;
+            int begin = (int)((long long)jobRows * index / threadCount);
+            int end = (int)((long long)jobRows * (index + 1) / threadCount);
+            lock.unlock();
+            if (begin < end)
+                (*fn)(begin, end);
+            lock.lock();
+            if (--remaining == 0)
+                done.notify_one();
+        }
+    }
+
+    // Pins the worker to the index-th CPU the process may run on. Elsewhere the OS places threads.
+    static void pinToCpu(int index)
+    {
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0)
+            return;
+        int target = index % CPU_COUNT(&allowed);
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (!CPU_ISSET(cpu, &allowed) || target-- > 0)
+                continue;
+            cpu_set_t single;
+            CPU_ZERO(&single);
+            CPU_SET(cpu, &single);
+            pthread_setaffinity_np(pthread_self(), sizeof(single), &single);
+            return;
+        }
+#else
+        (void)index;
+#endif
+    }
+
+    int threadCount;
+    std::vector<std::thread> workers;
+    std::mutex runMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int, int)> *job = nullptr;
+    int jobRows = 0;
+    int remaining = 0;
+    unsigned long long jobId = 0;
+    bool stopping = false;
+};
+
+// The pool for gridMemoryConfig().workerThreads, started on first use
+inline RowBandPool &rowBandPool()
+{
+    static RowBandPool pool(gridMemoryConfig().workerThreads);
+    return pool;
+}
+
+// Splits rows into one contiguous band per worker thread and runs fn(beginRow, endRow) for each.
+// The same split is used for first touch and for stepping, and band t always runs on the same
+// pinned worker, so on NUMA machines every thread computes on the pages it faulted in.
+template <typename Fn>
+inline void forEachRowBand(int rows, size_t totalBytes, Fn fn)
+{
+    int threads = std::min(gridMemoryConfig().workerThreads, rows);
+    if (threads <= 1 || totalBytes < PARALLEL_MIN_BYTES || RowBandPool::onWorkerThread())
+    {
+        fn(0, rows);
+        return;
+    }
+    rowBandPool().run(rows, std::function<void(int, int)>(fn));
+}
+
+// A raw block handed out by allocateGridMemory
+struct GridAllocation
+{
+    void *ptr = nullptr;
+    size_t bytes = 0;
+    bool mapped = false;
+    bool hugePages = false;
+};
+
+// Human readable size for messages, e.g. "512 bytes", "24 KB", "3 MB". Partial units round up, so
+// a non-zero size never reads as 0.
+inline std::string formatMemorySize(size_t bytes)
+{
+    const size_t KB = 1024, MB = 1024 * 1024;
+    if (bytes < KB)
+        return std::to_string(bytes) + " bytes";
+    if (bytes < MB)
+        return std::to_string((bytes + KB - 1) / KB) + " KB";
+    return std::to_string((bytes + MB - 1) / MB) + " MB";
+}
+
+// Returns cache-line aligned memory for a grid buffer, from mmap (optionally huge-page backed) for
+// large buffers. Throws std::bad_alloc when the allocation fails or would exceed the memory budget.
+// The memory is not initialized; callers first-touch it.
+inline GridAllocation allocateGridMemory(size_t bytes)
+{
+    GridMemoryConfig &config = gridMemoryConfig();
+    GridMemoryStats &stats = gridMemoryStats();
+    GridAllocation allocation;
+    if (bytes == 0)
+        return allocation;
+
+    // Mapped buffers are rounded up to whole huge pages; the budget is checked against what is charged
+    size_t charged = bytes;
+#ifdef GRID_MEMORY_USE_MMAP
+    if (bytes >= HUGE_PAGE_SIZE)
+        charged = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#endif
+    size_t inUseBefore = stats.bytesInUse.load();
+    if (config.budgetBytes > 0 && inUseBefore + charged > config.budgetBytes)
+    {
+        std::cerr << "Error: Grid buffer of " << formatMemorySize(charged) << " exceeds the memory budget of "
+                  << formatMemorySize(config.budgetBytes) << " (" << formatMemorySize(inUseBefore) << " already in use)"
+                  << std::endl;
+        throw std::bad_alloc();
+    }
+
+#ifdef GRID_MEMORY_USE_MMAP
+    if (bytes >= HUGE_PAGE_SIZE)
+    {
+        size_t length = charged;
+        void *ptr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (config.hugePages)
+        {
+            ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            allocation.hugePages = (ptr != MAP_FAILED);
+        }
+#endif
+        if (ptr == MAP_FAILED)
+        {
+            // No reserved huge pages: fall back to normal pages and ask for transparent huge pages
+            ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ptr == MAP_FAILED)
+                throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+            if (config.hugePages)
+                allocation.hugePages = (madvise(ptr, length, MADV_HUGEPAGE) == 0);
+#endif
+        }
+        allocation.ptr = ptr;
+        allocation.bytes = length;
+        allocation.mapped = true;
+    }
+#endif
+    if (!allocation.ptr)
+    {
+        allocation.ptr = ::operator new(bytes, std::align_val_t(CACHE_LINE_SIZE));
+        allocation.bytes = bytes;
+    }
+
+    size_t inUse = (stats.bytesInUse += allocation.bytes);
+    size_t peak = stats.peakBytes.load();
+    while (inUse > peak && !stats.peakBytes.compare_exchange_weak(peak, inUse))
+    {
+    }
+    if (allocation.hugePages)
+        stats.hugePageBytes += allocation.bytes;
+    return allocation;
+}
+
+inline void freeGridMemory(GridAllocation &allocation)
+{
+    if (!allocation.ptr)
+        return;
+    GridMemoryStats &stats = gridMemoryStats();
+    stats.bytesInUse -= allocation.bytes;
+    if (allocation.hugePages)
+        stats.hugePageBytes -= allocation.bytes;
+
+#ifdef GRID_MEMORY_USE_MMAP
+    if (allocation.mapped)
+        munmap(allocation.ptr, allocation.bytes);
+    else
+#endif
+        ::operator delete(allocation.ptr, std::align_val_t(CACHE_LINE_SIZE));
+    allocation = GridAllocation{};
+}
+
+// Human readable summary of grid memory use, e.g. for the settings screen
+inline std::string gridMemoryReport()
+{
+    const GridMemoryStats &stats = gridMemoryStats();
+    const GridMemoryConfig &config = gridMemoryConfig();
+    std::string report = "Grid memory: " + std::to_string(stats.bytesInUse / (1024 * 1024)) + " MB in use, " +
+                         std::to_string(stats.peakBytes / (1024 * 1024)) + " MB peak";
+    if (stats.hugePageBytes > 0)
+        report += ", " + std::to_string(stats.hugePageBytes / (1024 * 1024)) + " MB huge pages";
+    if (config.budgetBytes > 0)
+        report += " (budget " + std::to_string(config.budgetBytes / (1024 * 1024)) + " MB)";
+    return report;
+}
+
+// Dense cell storage, one byte per cell (0 = dead, 1 = live). Rows are padded to a whole number of
+// cache lines so every row starts aligned. Indexing as cells[row][col] returns the row pointer.
+class CellBuffer
+{
+public:
+    CellBuffer() = default;
+
+    CellBuffer(int rows, int cols) { reset(rows, cols); }
+
+    CellBuffer(const CellBuffer &other)
+    {
+        reset(other.numRows, other.numCols, false);
+        copyFrom(other);
+    }
+
+    CellBuffer(CellBuffer &&other) noexcept { swap(other); }
+
+    CellBuffer &operator=(const CellBuffer &other)
+    {
+        if (this != &other)
+        {
+            if (numRows != other.numRows || numCols != other.numCols)
+                reset(other.numRows, other.numCols, false);
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    CellBuffer &operator=(CellBuffer &&other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~CellBuffer() { freeGridMemory(allocation); }
+
+    void swap(CellBuffer &other) noexcept
+    {
+        std::swap(allocation, other.allocation);
+        std::swap(cells, other.cells);
+        std::swap(numRows, other.numRows);
+        std::swap(numCols, other.numCols);
+        std::swap(rowStride, other.rowStride);
+    }
+
+    // Reallocates for the given size. Unless the caller is about to overwrite the contents, they are
+    // cleared in row bands, so every page is first-touched by the pool worker that will step it.
+    void reset(int rows, int cols, bool clearCells = true)
+    {
+        freeGridMemory(allocation);
+        cells = nullptr;
+        numRows = std::max(rows, 0);
+        numCols = std::max(cols, 0);
+        rowStride = (numCols + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+        if (numRows == 0 || numCols == 0)
+            return;
+
+        try
+        {
+            allocation = allocateGridMemory(sizeBytes());
+        }
+        catch (const std::bad_alloc &)
+        {
+            numRows = numCols = 0; // Stay a valid, empty buffer
+            throw;
+        }
+        cells = static_cast<uint8_t *>(allocation.ptr);
+        if (clearCells)
+            clear();
+    }
+
+    void clear()
+    {
+        uint8_t *base = cells;
+        size_t stride = rowStride;
+        forEachRowBand(numRows, sizeBytes(), [=](int begin, int end)
+                       { std::memset(base + begin * stride, 0, (end - begin) * stride); });
+    }
+
+    uint8_t *operator[](int row) { return cells + (size_t)row * rowStride; }
+    const uint8_t *operator[](int row) const { return cells + (size_t)row * rowStride; }
+
+    uint8_t *data() { return cells; }
+    const uint8_t *data() const { return cells; }
+    int rows() const { return numRows; }
+    int cols() const { return numCols; }
+    size_t stride() const { return rowStride; }
+    size_t sizeBytes() const { return (size_t)numRows * rowStride; }
+
+    bool operator==(const CellBuffer &other) const
+    {
+        if (numRows != other.numRows || numCols != other.numCols)
+            return false;
+        for (int row = 0; row < numRows; ++row)
+        {
+            if (std::memcmp((*this)[row], other[row], numCols) != 0)
+                return false;
+        }
+        return true;
+    }
+    bool operator!=(const CellBuffer &other) const { return !(*this == other); }
+
+private:
+    void copyFrom(const CellBuffer &other)
+    {
+        uint8_t *dst = cells;
+        const uint8_t *src = other.cells;
+        size_t stride = rowStride;
+        forEachRowBand(numRows, sizeBytes(), [=](int begin, int end)
+                       { std::memcpy(dst + begin * stride, src + begin * stride, (end - begin) * stride); });
+    }
+
+    GridAllocation allocation;
+    uint8_t *cells = nullptr;
+    int numRows = 0;
+    int numCols = 0;
+    size_t rowStride = 0;
+};
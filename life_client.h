@@ -0,0 +1,239 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "net_protocol.h"
+#include "pre_game.h" // For GridRegion
+#include "app_options.h"
+
+#ifdef LIFE_NET_AVAILABLE
+
+// Viewer side of the protocol in net_protocol.h. Only the cells of the subscribed viewport are held
+// locally, so a viewer of a huge board needs no more memory than its window shows; the board size
+// from the server is just a number for the camera.
+class LifeClient
+{
+public:
+    bool connect(const std::string &address)
+    {
+        connection = NetConnection(connectTo(address));
+        return connection.isOpen();
+    }
+
+    bool connected() const { return connection.isOpen(); }
+    int socket() const { return connection.socket(); }
+
+    long long generation() const { return latestGeneration; }
+    long long framesReceived() const { return frames; }
+    long long keyframesReceived() const { return keyframes; }
+    long long bytesReceived() const { return frameBytes; }
+    const Viewport &frameViewport() const { return current; }
+    // Size of the server's board, 0x0 until the server has said hello
+    int boardRowCount() const { return std::max(boardRows, 0); }
+    int boardColCount() const { return std::max(boardCols, 0); }
+    // Cells of the latest frame, positioned in board coordinates
+    const GridRegion &region() const { return cells; }
+
+    // Asks the server for the given cells; does nothing if they are already subscribed
+    void subscribe(const Viewport &viewport)
+    {
+        if (!connected() || viewport == requested)
+            return;
+        requested = viewport;
+        std::vector<uint8_t> &out = connection.outgoing();
+        size_t start = beginMessage(out, NetMessage::SUBSCRIBE);
+        putU32(out, (uint32_t)viewport.top);
+        putU32(out, (uint32_t)viewport.left);
+        putU32(out, (uint32_t)viewport.height);
+        putU32(out, (uint32_t)viewport.width);
+        endMessage(out, start);
+        if (!connection.flush())
+            disconnect("Error: Lost connection to the server.");
+    }
+
+    // Applies everything received so far. Returns false once the connection is lost or the server
+    // sent something malformed.
+    bool poll()
+    {
+        if (!connected())
+            return false;
+        // Frames that arrived before the server closed the connection are still applied
+        bool open = connection.flush() && connection.receive();
+
+        NetMessage type;
+        bool error = false;
+        while (connection.nextMessage(type, payload, error))
+        {
+            bool ok = false;
+            if (type == NetMessage::HELLO)
+                ok = applyHello();
+            else if (type == NetMessage::FRAME)
+                ok = applyFrame();
+            if (!ok)
+            {
+                error = true;
+                break;
+            }
+        }
+        if (error)
+        {
+            disconnect("Error: Malformed message from the server.");
+            return false;
+        }
+        if (!open)
+        {
+            disconnect("Server closed the connection.");
+            return false;
+        }
+        return true;
+    }
+
+private:
+    void disconnect(const std::string &reason)
+    {
+        if (connected())
+            std::cerr << reason << std::endl;
+        connection.closeSocket();
+    }
+
+    bool applyHello()
+    {
+        if (payload.size() != 8)
+            return false;
+        boardRows = (int)getU32(&payload[0]);
+        boardCols = (int)getU32(&payload[4]);
+        if (boardRows < 0 || boardCols < 0)
+            return false;
+        bits.clear();
+        current = Viewport{};
+        cells = GridRegion{};
+        return true;
+    }
+
+    bool applyFrame()
+    {
+        const size_t headerSize = 25;
+        if (payload.size() < headerSize || boardRows < 0)
+            return false;
+        long long frameGeneration = (long long)((unsigned long long)getU32(&payload[0]) |
+                                                ((unsigned long long)getU32(&payload[4]) << 32));
+        Viewport view{(int)getU32(&payload[8]), (int)getU32(&payload[12]), (int)getU32(&payload[16]),
+                      (int)getU32(&payload[20])};
+        bool keyframe = (payload[24] & FRAME_KEYFRAME) != 0;
+        if (view.top < 0 || view.left < 0 || view.height < 0 || view.width < 0 ||
+            (long long)view.top + view.height > boardRows || (long long)view.left + view.width > boardCols)
+            return false;
+
+        size_t cellCount = (size_t)view.height * (size_t)view.width;
+        if (!decodeZeroRuns(payload.data() + headerSize, payload.size() - headerSize, (cellCount + 7) / 8, decoded))
+            return false;
+        if (keyframe)
+        {
+            bits.swap(decoded);
+        }
+        else
+        {
+            // A delta is only meaningful against the frame of the same viewport it was taken from
+            if (view != current || bits.size() != decoded.size())
+                return false;
+            for (size_t i = 0; i < bits.size(); ++i)
+                bits[i] ^= decoded[i];
+        }
+        current = view;
+
+        cells.area = view;
+        cells.cells.resize(cellCount);
+        for (size_t index = 0; index < cellCount; ++index)
+            cells.cells[index] = (bits[index / 8] >> (index % 8)) & 1;
+
+        latestGeneration = frameGeneration;
+        ++frames;
+        keyframes += keyframe;
+        frameBytes += (long long)(payload.size() + NET_HEADER_SIZE);
+        return true;
+    }
+
+    NetConnection connection;
+    Viewport requested;
+    Viewport current;
+    int boardRows = -1;
+    int boardCols = -1;
+    std::vector<uint8_t> bits; // Cells of the current viewport as of the last frame
+    GridRegion cells;          // The same cells, one byte each, for drawing
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> decoded;
+    long long latestGeneration = 0;
+    long long frames = 0;
+    long long keyframes = 0;
+    long long frameBytes = 0;
+};
+
+#else
+
+// Sockets are only implemented for POSIX systems; elsewhere connecting always fails
+class LifeClient
+{
+public:
+    bool connect(const std::string &)
+    {
+        std::cerr << "Error: Connecting to a server is not supported on this platform." << std::endl;
+        return false;
+    }
+    bool connected() const { return false; }
+    long long generation() const { return 0; }
+    int boardRowCount() const { return 0; }
+    int boardColCount() const { return 0; }
+    const GridRegion &region() const { return cells; }
+    void subscribe(const Viewport &) {}
+    bool poll() { return false; }
+
+private:
+    GridRegion cells;
+};
+
+#endif // LIFE_NET_AVAILABLE
+
+// Headless stand-in for a viewer: subscribes to options.testViewport, prints a line per received
+// batch of frames and a compression summary. Returns the process exit code.
+inline int runTestClient(const AppOptions &options)
+{
+#ifndef LIFE_NET_AVAILABLE
+    (void)options;
+    std::cerr << "Error: --test-client is not supported on this platform." << std::endl;
+    return 1;
+#else
+    LifeClient client;
+    if (!client.connect(options.testClientAddress))
+        return 1;
+    client.subscribe(options.testViewport);
+
+    long long lastReported = -1;
+    while (client.framesReceived() < options.testFrames)
+    {
+        pollfd fd{client.socket(), POLLIN, 0};
+        if (::poll(&fd, 1, 5000) == 0)
+        {
+            std::cerr << "Error: No data from the server for 5 seconds." << std::endl;
+            return 1;
+        }
+        if (!client.poll())
+            return 1;
+        if (client.framesReceived() == lastReported)
+            continue;
+        lastReported = client.framesReceived();
+
+        const Viewport &view = client.frameViewport();
+        const std::vector<uint8_t> &cells = client.region().cells;
+        long long live = std::count(cells.begin(), cells.end(), (uint8_t)1);
+        std::cout << "Generation " << client.generation() << ": " << live << " live cells in " << view.height << "x"
+                  << view.width << " at (" << view.top << ", " << view.left << ")" << std::endl;
+    }
+
+    const Viewport &view = client.frameViewport();
+    long long rawBytes = client.framesReceived() * (((long long)view.height * view.width + 7) / 8);
+    std::cout << client.framesReceived() << " frames (" << client.keyframesReceived() << " keyframes), "
+              << client.bytesReceived() << " bytes received, " << rawBytes << " bytes as raw bitmaps" << std::endl;
+    return 0;
+#endif
+}
@@ -0,0 +1,302 @@
+#pragma once
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "pre_game.h"
+#include "game_logic.h"
+
+// Process-wide engine tuning, set once from the command line
+struct EngineConfig
+{
+    double sparseDensityThreshold = 0.01; // Live fraction above which the sparse engine goes dense
+};
+
+inline EngineConfig &engineConfig()
+{
+    static EngineConfig config;
+    return config;
+}
+
+// Smallest rectangle containing every live cell (inclusive bounds)
+struct BoundingBox
+{
+    bool empty = true;
+    int minRow = 0;
+    int minCol = 0;
+    int maxRow = -1;
+    int maxCol = -1;
+};
+
+// A Game of Life simulation backend. The engine owns the board for the whole session: the UI edits
+// it with setCell(), draws it through exportRegion() of the visible cells, and only copies the whole
+// board out with exportCells() when it really needs it (file export, checkpoints). Cells outside
+// the board are always dead.
+class LifeEngine
+{
+public:
+    virtual ~LifeEngine() = default;
+
+    virtual std::string name() const = 0;
+    virtual int rows() const = 0;
+    virtual int cols() const = 0;
+
+    // Advances the board by the given number of generations
+    virtual void step(int generations = 1) = 0;
+
+    virtual bool getCell(int row, int col) const = 0;
+    virtual void setCell(int row, int col, bool alive) = 0;
+
+    // Replaces the board with an empty one of the given size
+    virtual void reset(int rows, int cols) = 0;
+    // Replaces the whole board with the cells of grid
+    virtual void importCells(const Grid &grid) = 0;
+    // Writes the board into grid, keeping its cell size and offsets
+    virtual void exportCells(Grid &grid) const = 0;
+
+    // Copies a rectangle of the board into out, row-major with one byte per cell. Lets callers that
+    // only need part of the board (e.g. a viewer's viewport) avoid exporting all of it.
+    virtual void exportRegion(int top, int left, int height, int width, std::vector<uint8_t> &out) const
+    {
+        out.assign((size_t)std::max(height, 0) * (size_t)std::max(width, 0), 0);
+        for (int r = 0; r < height; ++r)
+            for (int c = 0; c < width; ++c)
+                out[(size_t)r * width + c] = getCell(top + r, left + c);
+    }
+
+    virtual long long population() const
+    {
+        long long count = 0;
+        for (int row = 0; row < rows(); ++row)
+            for (int col = 0; col < cols(); ++col)
+                count += getCell(row, col);
+        return count;
+    }
+
+    virtual BoundingBox boundingBox() const
+    {
+        BoundingBox box;
+        for (int row = 0; row < rows(); ++row)
+            for (int col = 0; col < cols(); ++col)
+                if (getCell(row, col))
+                    extendBoundingBox(box, row, col);
+        return box;
+    }
+
+    // Non-empty when the engine detected an internal inconsistency (see LockstepEngine)
+    virtual std::string consistencyError() const { return ""; }
+
+    // Tells engines that report generations which generation the current board is, e.g. after
+    // loading a checkpoint or switching engines mid-run (see LockstepEngine)
+    virtual void setGeneration(long long) {}
+
+protected:
+    static void extendBoundingBox(BoundingBox &box, int row, int col)
+    {
+        if (box.empty)
+        {
+            box = BoundingBox{false, row, col, row, col};
+            return;
+        }
+        box.minRow = std::min(box.minRow, row);
+        box.minCol = std::min(box.minCol, col);
+        box.maxRow = std::max(box.maxRow, row);
+        box.maxCol = std::max(box.maxCol, col);
+    }
+};
+
+// Reference engine: the per-cell neighbour counting kernel from game_logic.h
+class ScalarEngine : public LifeEngine
+{
+public:
+    std::string name() const override { return "scalar"; }
+    int rows() const override { return state.rows; }
+    int cols() const override { return state.cols; }
+
+    void step(int generations) override
+    {
+        for (int i = 0; i < generations; ++i)
+            updateGrid(state, next);
+    }
+
+    bool getCell(int row, int col) const override
+    {
+        return row >= 0 && row < state.rows && col >= 0 && col < state.cols && state.cells[row][col];
+    }
+
+    void setCell(int row, int col, bool alive) override
+    {
+        if (row >= 0 && row < state.rows && col >= 0 && col < state.cols)
+            state.cells[row][col] = alive;
+    }
+
+    // The size is only updated once the cells are allocated, so a failed allocation leaves an empty board
+    void reset(int rows, int cols) override
+    {
+        state.rows = state.cols = 0;
+        state.cells.reset(rows, cols);
+        state.rows = rows;
+        state.cols = cols;
+    }
+
+    void importCells(const Grid &grid) override
+    {
+        state.rows = state.cols = 0;
+        state.cells = grid.cells;
+        state.rows = grid.rows;
+        state.cols = grid.cols;
+    }
+
+    void exportCells(Grid &grid) const override
+    {
+        grid.rows = state.rows;
+        grid.cols = state.cols;
+        grid.cells = state.cells;
+    }
+
+    void exportRegion(int top, int left, int height, int width, std::vector<uint8_t> &out) const override
+    {
+        out.assign((size_t)std::max(height, 0) * (size_t)std::max(width, 0), 0);
+        int firstCol = std::max(left, 0);
+        int lastCol = std::min(left + width, state.cols);
+        for (int r = std::max(top, 0); r < std::min(top + height, state.rows) && firstCol < lastCol; ++r)
+        {
+            const uint8_t *cells = state.cells[r];
+            std::copy(cells + firstCol, cells + lastCol, out.begin() + (size_t)(r - top) * width + (firstCol - left));
+        }
+    }
+
+    long long population() const override
+    {
+        long long count = 0;
+        for (int row = 0; row < state.rows; ++row)
+        {
+            const uint8_t *cells = state.cells[row];
+            for (int col = 0; col < state.cols; ++col)
+                count += cells[col];
+        }
+        return count;
+    }
+
+private:
+    Grid state = initGrid(0, 0, 0);
+    CellBuffer next;
+};
+
+// Debug engine that runs two engines in lockstep, one generation at a time, and reports the first
+// generation and cell where they disagree. The primary engine's state is what the UI sees.
+class LockstepEngine : public LifeEngine
+{
+public:
+    LockstepEngine(std::unique_ptr<LifeEngine> primary, std::unique_ptr<LifeEngine> shadow)
+        : primary(std::move(primary)), shadow(std::move(shadow)) {}
+
+    std::string name() const override { return primary->name() + " vs " + shadow->name(); }
+    int rows() const override { return primary->rows(); }
+    int cols() const override { return primary->cols(); }
+
+    void step(int generations) override
+    {
+        for (int i = 0; i < generations; ++i)
+        {
+            primary->step(1);
+            ++generation;
+            if (!divergence.empty())
+                continue; // Already reported; keep running the primary only
+            shadow->step(1);
+            compare();
+        }
+    }
+
+    bool getCell(int row, int col) const override { return primary->getCell(row, col); }
+
+    void setCell(int row, int col, bool alive) override
+    {
+        primary->setCell(row, col, alive);
+        shadow->setCell(row, col, alive);
+    }
+
+    void reset(int rows, int cols) override
+    {
+        bothOrNeither([&](LifeEngine &engine) { engine.reset(rows, cols); });
+    }
+
+    // Keeps the generation count, so re-importing a board mid-run still reports real generations
+    void importCells(const Grid &grid) override
+    {
+        bothOrNeither([&](LifeEngine &engine) { engine.importCells(grid); });
+    }
+
+    void setGeneration(long long newGeneration) override { generation = newGeneration; }
+
+    void exportCells(Grid &grid) const override { primary->exportCells(grid); }
+    void exportRegion(int top, int left, int height, int width, std::vector<uint8_t> &out) const override
+    {
+        primary->exportRegion(top, left, height, width, out);
+    }
+    long long population() const override { return primary->population(); }
+    BoundingBox boundingBox() const override { return primary->boundingBox(); }
+    std::string consistencyError() const override { return divergence; }
+
+private:
+    // Applies a board replacement to both engines. If either runs out of memory both are left empty,
+    // so a failed allocation is not reported as a divergence.
+    template <typename Replace>
+    void bothOrNeither(Replace replace)
+    {
+        divergence.clear();
+        try
+        {
+            replace(*primary);
+            replace(*shadow);
+        }
+        catch (const std::bad_alloc &)
+        {
+            primary->reset(0, 0);
+            shadow->reset(0, 0);
+            throw;
+        }
+    }
+
+    void compare()
+    {
+        primary->exportCells(primaryState);
+        shadow->exportCells(shadowState);
+        if (primaryState.rows != shadowState.rows || primaryState.cols != shadowState.cols)
+        {
+            report("board size " + std::to_string(primaryState.rows) + "x" + std::to_string(primaryState.cols) +
+                   " vs " + std::to_string(shadowState.rows) + "x" + std::to_string(shadowState.cols));
+            return;
+        }
+        if (primaryState.cells == shadowState.cells)
+            return;
+
+        for (int row = 0; row < primaryState.rows; ++row)
+        {
+            for (int col = 0; col < primaryState.cols; ++col)
+            {
+                if (primaryState.cells[row][col] != shadowState.cells[row][col])
+                {
+                    report("cell (" + std::to_string(row) + ", " + std::to_string(col) + "): " +
+                           primary->name() + "=" + std::to_string(primaryState.cells[row][col]) + ", " +
+                           shadow->name() + "=" + std::to_string(shadowState.cells[row][col]));
+                    return;
+                }
+            }
+        }
+    }
+
+    void report(const std::string &detail)
+    {
+        divergence = "Engines diverged at generation " + std::to_string(generation) + ", " + detail;
+        std::cerr << divergence << std::endl;
+    }
+
+    std::unique_ptr<LifeEngine> primary;
+    std::unique_ptr<LifeEngine> shadow;
+    Grid primaryState = initGrid(0, 0, 0);
+    Grid shadowState = initGrid(0, 0, 0);
+    long long generation = 0;
+    std::string divergence;
+};
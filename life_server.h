@@ -0,0 +1,356 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <csignal>
+#include "net_protocol.h"
+#include "app_options.h"
+#include "engine_factory.h"
+#include "file_io.h"
+#include "checkpoint.h"
+
+#ifdef LIFE_NET_AVAILABLE
+
+// Largest viewport a viewer may subscribe to, so one viewer cannot make the server extract most of
+// a huge board every generation
+const long long MAX_VIEWPORT_CELLS = 4096LL * 4096LL;
+// Output a viewer may have queued before frames to it are skipped
+const size_t MAX_CLIENT_BACKLOG = 4 * 1024 * 1024;
+
+inline volatile std::sig_atomic_t serverStopRequested = 0;
+
+inline void handleServerSignal(int)
+{
+    serverStopRequested = 1;
+}
+
+// A connected viewer and the last frame it was sent, which its next delta is taken against
+struct ServerClient
+{
+    NetConnection connection;
+    Viewport viewport; // Empty until the viewer subscribes
+    std::vector<uint8_t> lastSent;
+    long long sentGeneration = -1;
+    bool needKeyframe = true;
+};
+
+// Streams the board held by an engine to any number of viewers. Each viewer subscribes to a
+// viewport and is sent only those cells, one bit per cell: a keyframe when it (re)subscribes, then
+// per generation the XOR against the previous frame it received, zero-run encoded. A viewer that
+// cannot keep up has frames skipped; since the next delta is still taken against what it actually
+// received, it catches up without a keyframe.
+class LifeServer
+{
+public:
+    explicit LifeServer(const LifeEngine &engine) : engine(engine) {}
+    LifeServer(const LifeServer &) = delete;
+    LifeServer &operator=(const LifeServer &) = delete;
+
+    ~LifeServer()
+    {
+        if (listenFd >= 0)
+            close(listenFd);
+        if (!unixPath.empty())
+            removeSocketFile(unixPath);
+    }
+
+    bool listen(const std::string &address)
+    {
+        listenFd = listenOn(address);
+        if (listenFd < 0)
+            return false;
+        if (address.compare(0, 5, "unix:") == 0)
+            unixPath = address.substr(5);
+        return true;
+    }
+
+    size_t clientCount() const { return clients.size(); }
+    long long framesSent() const { return sentFrames; }
+    long long framesSkipped() const { return skippedFrames; }
+    long long bytesSent() const { return sentBytes; }
+
+    // Waits up to timeoutMs for socket activity, then accepts viewers, applies their subscriptions
+    // and sends queued output
+    void serviceSockets(int timeoutMs)
+    {
+        std::vector<pollfd> fds;
+        fds.push_back({listenFd, POLLIN, 0});
+        for (const ServerClient &client : clients)
+        {
+            short events = POLLIN;
+            if (client.connection.pendingOutput() > 0)
+                events |= POLLOUT;
+            fds.push_back({client.connection.socket(), events, 0});
+        }
+        if (::poll(fds.data(), fds.size(), timeoutMs) <= 0)
+            return; // Timeout, or interrupted by a signal
+
+        for (size_t i = 0; i < clients.size(); ++i)
+        {
+            ServerClient &client = clients[i];
+            bool ok = true;
+            if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))
+                ok = client.connection.receive() && handleMessages(client);
+            if (ok)
+                ok = client.connection.flush();
+            if (!ok)
+                client.connection.closeSocket();
+        }
+        removeClosedClients();
+
+        if (fds[0].revents & POLLIN)
+            acceptClients();
+    }
+
+    // Sends every subscribed viewer its frame of the given generation
+    void publish(long long newGeneration)
+    {
+        generation = newGeneration;
+        for (ServerClient &client : clients)
+        {
+            sendFrame(client);
+            if (!client.connection.flush())
+                client.connection.closeSocket();
+        }
+        removeClosedClients();
+    }
+
+private:
+    void acceptClients()
+    {
+        while (true)
+        {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0)
+                return; // EAGAIN: no more pending connections
+            setNonBlocking(fd);
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)); // Fails harmlessly on Unix sockets
+#ifdef SO_NOSIGPIPE
+            setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+            clients.emplace_back();
+            ServerClient &client = clients.back();
+            client.connection = NetConnection(fd);
+
+            std::vector<uint8_t> &out = client.connection.outgoing();
+            size_t start = beginMessage(out, NetMessage::HELLO);
+            putU32(out, (uint32_t)engine.rows());
+            putU32(out, (uint32_t)engine.cols());
+            endMessage(out, start);
+            client.connection.flush();
+            std::cout << "Viewer connected (" << clients.size() << " connected)" << std::endl;
+        }
+    }
+
+    void removeClosedClients()
+    {
+        size_t before = clients.size();
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                     [](const ServerClient &client) { return !client.connection.isOpen(); }),
+                      clients.end());
+        if (clients.size() != before)
+            std::cout << "Viewer disconnected (" << clients.size() << " connected)" << std::endl;
+    }
+
+    // Returns false if the viewer sent something malformed
+    bool handleMessages(ServerClient &client)
+    {
+        NetMessage type;
+        bool error = false;
+        while (client.connection.nextMessage(type, payload, error))
+        {
+            if (type != NetMessage::SUBSCRIBE || payload.size() != 16)
+                return false;
+            Viewport requested;
+            requested.top = (int32_t)getU32(&payload[0]);
+            requested.left = (int32_t)getU32(&payload[4]);
+            requested.height = (int32_t)getU32(&payload[8]);
+            requested.width = (int32_t)getU32(&payload[12]);
+            Viewport viewport = clampViewport(requested);
+            if (viewport != client.viewport)
+            {
+                client.viewport = viewport;
+                client.needKeyframe = true;
+                sendFrame(client); // Answer right away rather than at the next generation
+            }
+        }
+        return !error;
+    }
+
+    Viewport clampViewport(Viewport viewport) const
+    {
+        int top = std::max(viewport.top, 0);
+        int left = std::max(viewport.left, 0);
+        long long bottom = std::min((long long)viewport.top + viewport.height, (long long)engine.rows());
+        long long right = std::min((long long)viewport.left + viewport.width, (long long)engine.cols());
+        if (bottom <= top || right <= left)
+            return Viewport{};
+        Viewport clamped{top, left, (int)(bottom - top), (int)std::min(right - left, MAX_VIEWPORT_CELLS)};
+        if ((long long)clamped.height * clamped.width > MAX_VIEWPORT_CELLS)
+            clamped.height = std::max(1, (int)(MAX_VIEWPORT_CELLS / clamped.width));
+        return clamped;
+    }
+
+    void sendFrame(ServerClient &client)
+    {
+        if (client.viewport.empty() || (client.sentGeneration == generation && !client.needKeyframe))
+            return;
+        if (client.connection.pendingOutput() > MAX_CLIENT_BACKLOG)
+        {
+            ++skippedFrames;
+            return;
+        }
+
+        const Viewport &view = client.viewport;
+        engine.exportRegion(view.top, view.left, view.height, view.width, cells);
+        packBits(cells, bits);
+        bool keyframe = client.needKeyframe;
+        if (!keyframe)
+        {
+            delta.resize(bits.size());
+            for (size_t i = 0; i < bits.size(); ++i)
+                delta[i] = bits[i] ^ client.lastSent[i];
+        }
+
+        std::vector<uint8_t> &out = client.connection.outgoing();
+        size_t before = out.size();
+        size_t start = beginMessage(out, NetMessage::FRAME);
+        putU32(out, (uint32_t)generation);
+        putU32(out, (uint32_t)((unsigned long long)generation >> 32));
+        putU32(out, (uint32_t)view.top);
+        putU32(out, (uint32_t)view.left);
+        putU32(out, (uint32_t)view.height);
+        putU32(out, (uint32_t)view.width);
+        out.push_back(keyframe ? FRAME_KEYFRAME : 0);
+        encodeZeroRuns(keyframe ? bits : delta, out);
+        endMessage(out, start);
+
+        client.lastSent.swap(bits);
+        client.sentGeneration = generation;
+        client.needKeyframe = false;
+        ++sentFrames;
+        sentBytes += (long long)(out.size() - before);
+    }
+
+    const LifeEngine &engine;
+    int listenFd = -1;
+    std::string unixPath;
+    std::vector<ServerClient> clients;
+    long long generation = 0;
+    long long sentFrames = 0;
+    long long skippedFrames = 0;
+    long long sentBytes = 0;
+    // Scratch buffers reused across frames
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> cells;
+    std::vector<uint8_t> bits;
+    std::vector<uint8_t> delta;
+};
+
+#endif // LIFE_NET_AVAILABLE
+
+// Runs the simulation without a window, serving it to viewers on options.serverAddress until
+// interrupted. Returns the process exit code.
+inline int runServer(const AppOptions &options)
+{
+#ifndef LIFE_NET_AVAILABLE
+    (void)options;
+    std::cerr << "Error: --server is not supported on this platform." << std::endl;
+    return 1;
+#else
+    std::unique_ptr<LifeEngine> engine = createEngine(options.engineName, options.crossCheckEngine);
+    long long generation = 0;
+    try
+    {
+        if (options.loadPath.empty())
+        {
+            engine->reset(options.rows, options.cols);
+        }
+        else
+        {
+            // A checkpoint resumes at the generation it was written at
+            Grid loaded{};
+            if (!importGrid(loaded, options.loadPath, nullptr, &generation))
+                return 1;
+            engine->importCells(loaded);
+            engine->setGeneration(generation);
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+        std::cerr << "Error: Could not allocate a " << options.rows << "x" << options.cols << " grid." << std::endl;
+        return 1;
+    }
+
+    LifeServer server(*engine);
+    if (!server.listen(options.serverAddress))
+        return 1;
+    Checkpointer checkpointer;
+    checkpointer.configure(options.checkpoint);
+
+    serverStopRequested = 0;
+    std::signal(SIGINT, handleServerSignal);
+    std::signal(SIGTERM, handleServerSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+    std::cout << "Serving a " << engine->rows() << "x" << engine->cols() << " board (" << engine->name()
+              << " engine) on " << options.serverAddress << std::endl;
+    std::cout << gridMemoryReport() << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    const std::chrono::milliseconds stepInterval(options.stepIntervalMs);
+    const std::chrono::seconds reportInterval(10);
+    Clock::time_point nextStep = Clock::now();
+    Clock::time_point nextReport = nextStep + reportInterval;
+    int exitCode = 0;
+
+    while (!serverStopRequested)
+    {
+        Clock::time_point now = Clock::now();
+        int timeoutMs = 0;
+        if (nextStep > now)
+            timeoutMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(nextStep - now).count() + 1;
+        server.serviceSockets(timeoutMs);
+
+        now = Clock::now();
+        if (now < nextStep)
+            continue;
+        // Fall behind rather than burst when a step takes longer than the interval
+        nextStep = std::max(nextStep + stepInterval, now);
+
+        try
+        {
+            engine->step(1);
+            ++generation;
+        }
+        catch (const std::bad_alloc &)
+        {
+            std::cerr << "Error: Not enough memory to step the grid." << std::endl;
+            exitCode = 1;
+            break;
+        }
+        checkpointer.onGeneration(*engine, generation);
+        checkpointer.poll();
+        server.publish(generation);
+
+        if (!engine->consistencyError().empty())
+        {
+            exitCode = 1; // LockstepEngine has already reported the divergence
+            break;
+        }
+        if (now >= nextReport)
+        {
+            nextReport = now + reportInterval;
+            std::cout << "Generation " << generation << ", " << server.clientCount() << " viewers, "
+                      << server.framesSent() << " frames (" << server.bytesSent() << " bytes) sent, "
+                      << server.framesSkipped() << " skipped" << std::endl;
+        }
+    }
+
+    std::cout << "Server stopped at generation " << generation << std::endl;
+    return exitCode;
+#endif
+}
@@ -1,15 +1,21 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <functional>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_image.h> // For loading PNGs for the icon
 
 #include "ui.hpp"
 #include "pre_game.h"
-#include "game_logic.h"
+#include "engine_factory.h"
 #include "settings_menu.h"
 #include "file_io.h"
+#include "recorder.h"
+#include "checkpoint.h"
+#include "app_options.h"
+#include "life_server.h"
+#include "life_client.h"
 
 const int SCREEN_WIDTH = 1280;
 const int SCREEN_HEIGHT = 720;
@@ -65,6 +71,24 @@ void renderText(SDL_Renderer *renderer, TTF_Font *font, const std::string &text,
 
 int main(int argc, char *argv[])
 {
+    AppOptions options;
+    if (!parseArgs(argc, argv, options))
+        return 1;
+    gridMemoryConfig() = options.memory;
+    engineConfig() = options.engine;
+
+    // Headless modes never open a window
+    if (!options.serverAddress.empty())
+        return runServer(options);
+    if (!options.testClientAddress.empty())
+        return runTestClient(options);
+
+    // Viewer mode: the simulation runs in a server and this window only shows what it streams
+    bool viewerMode = !options.connectAddress.empty();
+    LifeClient client;
+    if (viewerMode && !client.connect(options.connectAddress))
+        return 1;
+
     // INITIALIZATION
     if (SDL_Init(SDL_INIT_VIDEO) < 0)
         return 1;
@@ -98,12 +122,53 @@ int main(int argc, char *argv[])
     // Settings UI Elements
     Button invertScrollCheckbox(100, 100, 450, 40, "[ ] Invert Mouse Scrolling");
     Button showCenterCheckbox(100, 150, 450, 40, "[X] Show Grid Center");
+    Button fileNameField(100, 200, 570, 40, "");
     Button importButton(100, 250, 200, 40, "Import Grid");
     Button exportButton(310, 250, 200, 40, "Export Grid");
+    Button cancelButton(520, 250, 150, 40, "Cancel");
+    Button recordCheckbox(100, 350, 450, 40, "[ ] Record Frames");
+    Button engineButton(100, 400, 450, 40, "");
 
     // GAME AND APP STATE
     GameState currentState = GameState::PRE_GAME;
-    Grid grid = initGrid(200, 200, 20);
+    // The engine (or, for a viewer, the server) holds the board; grid only keeps its size and the
+    // camera. Drawing exports just the visible cells into region each frame.
+    Grid grid = initGrid(0, 0, 20);
+    GridRegion region;
+    std::string engineName = options.engineName;
+    std::unique_ptr<LifeEngine> engine = createEngine(engineName, options.crossCheckEngine);
+    long long generation = 0;
+    if (!viewerMode)
+    {
+        try
+        {
+            if (options.loadPath.empty())
+            {
+                engine->reset(options.rows, options.cols);
+            }
+            else
+            {
+                // A checkpoint resumes at the generation it was written at
+                Grid loaded{};
+                if (!importGrid(loaded, options.loadPath, nullptr, &generation))
+                    return 1;
+                engine->importCells(loaded);
+                engine->setGeneration(generation);
+            }
+        }
+        catch (const std::bad_alloc &)
+        {
+            std::cerr << "Error: Could not allocate a " << options.rows << "x" << options.cols << " grid." << std::endl;
+            return 1;
+        }
+        grid.rows = engine->rows();
+        grid.cols = engine->cols();
+    }
+    std::cout << gridMemoryReport() << std::endl;
+    engineButton.text = "Engine: " + engine->name();
+    std::function<void(int, int)> toggleCell;
+    if (!viewerMode)
+        toggleCell = [&engine](int row, int col) { engine->setCell(row, col, !engine->getCell(row, col)); };
     float preciseCellSize = (float)grid.cellSize;
     InputState input;
     bool running = true;
@@ -113,6 +178,18 @@ int main(int argc, char *argv[])
     bool showCenterMarker = true;
     std::string statusMessage = "";
     Uint32 statusMessageTimeout = 0;
+    std::string saveFilePath = DEFAULT_SAVE_FILE;
+    bool editingFileName = false;
+    GridFileJob fileJob;
+    updateFileNameLabel(fileNameField, saveFilePath, editingFileName);
+    Recorder recorder;
+    Checkpointer checkpointer;
+    checkpointer.configure(options.checkpoint);
+    if (options.recordOnStart)
+    {
+        recorder.start(options.record);
+        recordCheckbox.text = "[X] Record Frames";
+    }
 
     // MAIN LOOP
     while (running)
@@ -225,24 +302,42 @@ int main(int argc, char *argv[])
                     currentState = (currentState == GameState::SETTINGS) ? GameState::PRE_GAME : GameState::SETTINGS;
                     settingsButton.text = (currentState == GameState::SETTINGS) ? "Back" : "Settings";
                     startButton.text = "Start"; // Set to default
+                    if (editingFileName)
+                        stopEditingFileName(saveFilePath, editingFileName, fileNameField);
                     eventHandled = true;
                 }
 
                 if (currentState == GameState::SETTINGS)
                 {
-                    handleSettingsEvent(event, grid, invertMouseScrolling, invertScrollCheckbox, showCenterMarker, showCenterCheckbox, importButton, exportButton, statusMessage, statusMessageTimeout);
+                    handleSettingsEvent(event, generation, viewerMode, invertMouseScrolling, invertScrollCheckbox, showCenterMarker, showCenterCheckbox,
+                                        saveFilePath, editingFileName, fileNameField, importButton, exportButton, cancelButton,
+                                        fileJob, recorder, options.record, recordCheckbox,
+                                        engineName, options.crossCheckEngine, engine, engineButton,
+                                        statusMessage, statusMessageTimeout);
                 }
                 else
                 {
-                    if (startButton.isClicked(mouseX, mouseY))
+                    if (startButton.isClicked(mouseX, mouseY) && !viewerMode)
                     {
                         currentState = (currentState == GameState::RUNNING) ? GameState::PRE_GAME : GameState::RUNNING;
                         startButton.text = (currentState == GameState::RUNNING) ? "Pause" : "Start";
                         eventHandled = true;
                     }
-                    else if (clearButton.isClicked(mouseX, mouseY) && currentState == GameState::PRE_GAME)
+                    else if (clearButton.isClicked(mouseX, mouseY) && currentState == GameState::PRE_GAME && !viewerMode)
                     {
-                        clearGrid(grid);
+                        try
+                        {
+                            engine->reset(grid.rows, grid.cols);
+                        }
+                        catch (const std::bad_alloc &)
+                        {
+                            grid.rows = engine->rows();
+                            grid.cols = engine->cols();
+                            statusMessage = "Error: Not enough memory to clear the grid.";
+                            statusMessageTimeout = SDL_GetTicks() + 4000;
+                        }
+                        generation = 0;
+                        engine->setGeneration(0);
                         eventHandled = true;
                     }
                     else if (centerButton.isClicked(mouseX, mouseY))
@@ -262,12 +357,13 @@ int main(int argc, char *argv[])
             switch (currentState)
             {
             case GameState::PRE_GAME:
-                handlePreGameEvent(event, grid, input, window, true);
+                handlePreGameEvent(event, grid, input, window, toggleCell);
                 break;
             case GameState::RUNNING:
-                handlePreGameEvent(event, grid, input, window, false);
+                handlePreGameEvent(event, grid, input, window, {});
                 break;
             case GameState::SETTINGS:
+                handleSettingsTextEvent(event, saveFilePath, editingFileName, fileNameField);
                 break;
             }
         }
@@ -278,10 +374,94 @@ int main(int argc, char *argv[])
             Uint32 currentTime = SDL_GetTicks();
             if (currentTime - lastUpdateTime > updateInterval)
             {
-                updateGrid(grid);
+                try
+                {
+                    engine->step(1);
+                    ++generation;
+
+                    int w, h;
+                    SDL_GetWindowSize(window, &w, &h);
+                    recorder.capture(*engine, grid, generation, w, h);
+                }
+                catch (const std::bad_alloc &)
+                {
+                    currentState = GameState::PRE_GAME;
+                    startButton.text = "Start";
+                    statusMessage = "Error: Not enough memory to step the grid.";
+                    statusMessageTimeout = SDL_GetTicks() + 4000;
+                }
+                // A failed checkpoint is logged and skipped; it never pauses the run
+                if (currentState == GameState::RUNNING)
+                    checkpointer.onGeneration(*engine, generation);
                 lastUpdateTime = currentTime;
+
+                // Cross-check mode: pause at the first divergence so the board can be inspected
+                std::string engineError = engine->consistencyError();
+                if (!engineError.empty())
+                {
+                    currentState = GameState::PRE_GAME;
+                    startButton.text = "Start";
+                    statusMessage = engineError;
+                    statusMessageTimeout = SDL_GetTicks() + 10000;
+                }
             }
         }
+        checkpointer.poll();
+
+        // Show the cells the server sends for the visible part of the board
+        if (viewerMode && client.connected())
+        {
+            int w, h;
+            SDL_GetWindowSize(window, &w, &h);
+            client.subscribe(visibleViewport(grid, w, h));
+            if (!client.poll())
+            {
+                statusMessage = "Disconnected from the server.";
+                statusMessageTimeout = SDL_GetTicks() + 10000;
+            }
+            else if (grid.rows != client.boardRowCount() || grid.cols != client.boardColCount())
+            {
+                grid.rows = client.boardRowCount();
+                grid.cols = client.boardColCount();
+                jumpToCenter(grid, w, h);
+            }
+            generation = client.generation();
+        }
+
+        // Background import/export completion. An imported board goes straight into the engine.
+        GridFileJob::Kind completedKind;
+        GridFileJob::Result completedResult;
+        Grid imported{};
+        long long importedGeneration = 0;
+        if (fileJob.poll(imported, importedGeneration, completedKind, completedResult))
+        {
+            reportFileJobResult(completedKind, completedResult, statusMessage, statusMessageTimeout);
+            if (completedKind == GridFileJob::Kind::IMPORT && completedResult == GridFileJob::Result::SUCCESS)
+            {
+                try
+                {
+                    engine->importCells(imported);
+                    generation = importedGeneration;
+                    engine->setGeneration(generation);
+                }
+                catch (const std::bad_alloc &)
+                {
+                    if (currentState == GameState::RUNNING)
+                    {
+                        currentState = GameState::PRE_GAME;
+                        startButton.text = "Start";
+                    }
+                    statusMessage = "Error: Not enough memory to load the imported grid.";
+                    statusMessageTimeout = SDL_GetTicks() + 4000;
+                }
+                if (!viewerMode)
+                {
+                    grid.rows = engine->rows();
+                    grid.cols = engine->cols();
+                }
+            }
+        }
+
         // Status message timeout
         if (SDL_GetTicks() > statusMessageTimeout)
         {
@@ -296,11 +476,19 @@ int main(int argc, char *argv[])
 
         if (currentState == GameState::PRE_GAME || currentState == GameState::RUNNING)
         {
-            renderGrid(renderer, grid, showCenterMarker);
+            int outputW, outputH;
+            if (!viewerMode && SDL_GetRendererOutputSize(renderer, &outputW, &outputH) == 0)
+            {
+                region.area = visibleViewport(grid, outputW, outputH);
+                engine->exportRegion(region.area.top, region.area.left, region.area.height, region.area.width,
+                                     region.cells);
+            }
+            renderGrid(renderer, grid, viewerMode ? client.region() : region, showCenterMarker);
         }
         else
         { // SETTINGS
-            renderSettings(renderer, font, invertScrollCheckbox, showCenterCheckbox, importButton, exportButton);
+            renderSettings(renderer, font, invertScrollCheckbox, showCenterCheckbox, fileNameField,
+                           importButton, exportButton, cancelButton, fileJob, recordCheckbox, engineButton, viewerMode);
         }
 
         // Draw UI on top
@@ -317,16 +505,26 @@ int main(int argc, char *argv[])
             clearButton.borderColor = isClearEnabled ? enabledColor : disabledColor;
             clearButton.textColor = isClearEnabled ? enabledColor : disabledColor;
 
-            startButton.draw(renderer, font);
-            clearButton.draw(renderer, font);
+            if (viewerMode)
+            {
+                renderText(renderer, font, "Viewing " + options.connectAddress + ", generation " + std::to_string(generation),
+                           100, h - 90, {180, 180, 180, 255});
+            }
+            else
+            {
+                startButton.draw(renderer, font);
+                clearButton.draw(renderer, font);
+            }
             centerButton.draw(renderer, font);
         }
         else
         {
-            // Render status message in settings
-            renderText(renderer, font, statusMessage, 100, h - 50, {255, 255, 0, 255});
+            renderText(renderer, font, gridMemoryReport(), 100, h - 90, {180, 180, 180, 255});
         }
 
+        // Status messages are shown in every state so errors during a run (e.g. engine divergence) are visible
+        renderText(renderer, font, statusMessage, 100, h - 50, {255, 255, 0, 255});
+
         SDL_RenderPresent(renderer);
     }
 
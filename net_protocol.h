@@ -0,0 +1,442 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include "pre_game.h" // For Viewport
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <cerrno>
+#define LIFE_NET_AVAILABLE 1
+#endif
+
+// Wire protocol between the headless simulation server and its viewers.
+// Every message is [type: u8][payload length: u32][payload]; integers are little-endian.
+//
+//   HELLO     server -> client  rows u32, cols u32. Sent on connect and whenever the board size changes.
+//   FRAME     server -> client  generation u64, top u32, left u32, height u32, width u32, flags u8,
+//                               then the zero-run encoded viewport bits (row-major, one bit per cell).
+//                               With FRAME_KEYFRAME the bits are the cells themselves, otherwise they
+//                               are XOR-ed with the previous frame the client received.
+//   SUBSCRIBE client -> server  top u32, left u32, height u32, width u32: the cells the client shows.
+enum class NetMessage : uint8_t
+{
+    HELLO = 1,
+    FRAME = 2,
+    SUBSCRIBE = 3
+};
+
+const uint8_t FRAME_KEYFRAME = 1;
+const size_t NET_HEADER_SIZE = 5;
+const uint32_t MAX_NET_PAYLOAD = 64 * 1024 * 1024;
+
+inline void putU32(std::vector<uint8_t> &out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        out.push_back((uint8_t)(value >> (8 * i)));
+}
+
+inline uint32_t getU32(const uint8_t *data)
+{
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+// Appends a message header; the length is filled in by endMessage()
+inline size_t beginMessage(std::vector<uint8_t> &out, NetMessage type)
+{
+    size_t start = out.size();
+    out.push_back((uint8_t)type);
+    putU32(out, 0);
+    return start;
+}
+
+inline void endMessage(std::vector<uint8_t> &out, size_t start)
+{
+    uint32_t length = (uint32_t)(out.size() - start - NET_HEADER_SIZE);
+    for (int i = 0; i < 4; ++i)
+        out[start + 1 + i] = (uint8_t)(length >> (8 * i));
+}
+
+// Packs one byte per cell into one bit per cell
+inline void packBits(const std::vector<uint8_t> &cells, std::vector<uint8_t> &bits)
+{
+    bits.assign((cells.size() + 7) / 8, 0);
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+        if (cells[i])
+            bits[i / 8] |= (uint8_t)(1 << (i % 8));
+    }
+}
+
+// Zero-run encoding: a zero byte is followed by a varint count of zero bytes in the run, any other
+// byte is copied. Life viewports, and even more so XOR deltas between generations, are mostly zeros.
+inline void encodeZeroRuns(const std::vector<uint8_t> &data, std::vector<uint8_t> &out)
+{
+    size_t i = 0;
+    while (i < data.size())
+    {
+        if (data[i] != 0)
+        {
+            out.push_back(data[i++]);
+            continue;
+        }
+        size_t run = 0;
+        while (i < data.size() && data[i] == 0)
+        {
+            ++run;
+            ++i;
+        }
+        out.push_back(0);
+        while (run >= 0x80)
+        {
+            out.push_back((uint8_t)(run | 0x80));
+            run >>= 7;
+        }
+        out.push_back((uint8_t)run);
+    }
+}
+
+// Returns false if the input is malformed or does not decode to exactly expectedSize bytes
+inline bool decodeZeroRuns(const uint8_t *data, size_t length, size_t expectedSize, std::vector<uint8_t> &out)
+{
+    out.clear();
+    out.reserve(expectedSize);
+    size_t i = 0;
+    while (i < length)
+    {
+        uint8_t value = data[i++];
+        if (value != 0)
+        {
+            out.push_back(value);
+            continue;
+        }
+        size_t run = 0;
+        int shift = 0;
+        while (true)
+        {
+            if (i >= length || shift > 56)
+                return false;
+            uint8_t part = data[i++];
+            run |= (size_t)(part & 0x7F) << shift;
+            shift += 7;
+            if (!(part & 0x80))
+                break;
+        }
+        if (out.size() + run > expectedSize)
+            return false;
+        out.insert(out.end(), run, 0);
+    }
+    return out.size() == expectedSize;
+}
+
+#ifdef LIFE_NET_AVAILABLE
+
+inline bool setNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Creates a stream socket that does not raise SIGPIPE when the peer goes away
+inline int createSocket(int family)
+{
+    int fd = socket(family, SOCK_STREAM, 0);
+#ifdef SO_NOSIGPIPE
+    if (fd >= 0)
+    {
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    }
+#endif
+    return fd;
+}
+
+// Splits "tcp:HOST:PORT" / "tcp:PORT" into host and port; returns false for other schemes
+inline bool parseTcpAddress(const std::string &address, std::string &host, std::string &port)
+{
+    if (address.compare(0, 4, "tcp:") != 0)
+        return false;
+    std::string rest = address.substr(4);
+    size_t colon = rest.rfind(':');
+    host = (colon == std::string::npos) ? "" : rest.substr(0, colon);
+    port = (colon == std::string::npos) ? rest : rest.substr(colon + 1);
+    return !port.empty();
+}
+
+// Removes path if it is a Unix domain socket. Anything else at that path (e.g. a mistyped
+// unix:FILE pointing at a real file) is left alone.
+inline void removeSocketFile(const std::string &path)
+{
+    struct stat existing;
+    if (lstat(path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode))
+        unlink(path.c_str());
+}
+
+// Listens on "unix:PATH", "tcp:PORT" or "tcp:HOST:PORT". Returns a non-blocking socket or -1.
+// The server has no authentication, so "tcp:PORT" only listens on loopback; other machines can
+// connect only when a host such as 0.0.0.0 is given explicitly.
+inline int listenOn(const std::string &address)
+{
+    int fd = -1;
+    if (address.compare(0, 5, "unix:") == 0)
+    {
+        std::string path = address.substr(5);
+        sockaddr_un addr{};
+        if (path.empty() || path.size() >= sizeof(addr.sun_path))
+        {
+            std::cerr << "Error: Invalid socket path: " << path << std::endl;
+            return -1;
+        }
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        struct stat existing;
+        if (lstat(path.c_str(), &existing) == 0 && !S_ISSOCK(existing.st_mode))
+        {
+            std::cerr << "Error: " << path << " exists and is not a socket." << std::endl;
+            return -1;
+        }
+        removeSocketFile(path); // A stale socket left by a previous run
+        fd = createSocket(AF_UNIX);
+        if (fd < 0 || bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0)
+        {
+            std::cerr << "Error: Could not bind " << address << ": " << std::strerror(errno) << std::endl;
+            if (fd >= 0)
+                close(fd);
+            return -1;
+        }
+    }
+    else
+    {
+        std::string host, port;
+        if (!parseTcpAddress(address, host, port))
+        {
+            std::cerr << "Error: Address must be unix:PATH or tcp:[HOST:]PORT, got " << address << std::endl;
+            return -1;
+        }
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        if (host.empty())
+            host = "127.0.0.1";
+        addrinfo *results = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &results) != 0)
+        {
+            std::cerr << "Error: Could not resolve " << address << std::endl;
+            return -1;
+        }
+        for (addrinfo *ai = results; ai && fd < 0; ai = ai->ai_next)
+        {
+            fd = createSocket(ai->ai_family);
+            if (fd < 0)
+                continue;
+            int on = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            if (bind(fd, ai->ai_addr, ai->ai_addrlen) != 0)
+            {
+                close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(results);
+        if (fd < 0)
+        {
+            std::cerr << "Error: Could not bind " << address << ": " << std::strerror(errno) << std::endl;
+            return -1;
+        }
+    }
+
+    if (listen(fd, 16) != 0 || !setNonBlocking(fd))
+    {
+        std::cerr << "Error: Could not listen on " << address << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Connects to "unix:PATH" or "tcp:HOST:PORT". Returns a non-blocking socket or -1.
+inline int connectTo(const std::string &address)
+{
+    int fd = -1;
+    if (address.compare(0, 5, "unix:") == 0)
+    {
+        std::string path = address.substr(5);
+        sockaddr_un addr{};
+        if (path.empty() || path.size() >= sizeof(addr.sun_path))
+        {
+            std::cerr << "Error: Invalid socket path: " << path << std::endl;
+            return -1;
+        }
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        fd = createSocket(AF_UNIX);
+        if (fd >= 0 && connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    else
+    {
+        std::string host, port;
+        if (!parseTcpAddress(address, host, port))
+        {
+            std::cerr << "Error: Address must be unix:PATH or tcp:HOST:PORT, got " << address << std::endl;
+            return -1;
+        }
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo *results = nullptr;
+        if (getaddrinfo(host.empty() ? "localhost" : host.c_str(), port.c_str(), &hints, &results) != 0)
+        {
+            std::cerr << "Error: Could not resolve " << address << std::endl;
+            return -1;
+        }
+        for (addrinfo *ai = results; ai && fd < 0; ai = ai->ai_next)
+        {
+            fd = createSocket(ai->ai_family);
+            if (fd >= 0 && connect(fd, ai->ai_addr, ai->ai_addrlen) != 0)
+            {
+                close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(results);
+        if (fd >= 0)
+        {
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+    }
+
+    if (fd < 0)
+    {
+        std::cerr << "Error: Could not connect to " << address << ": " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    setNonBlocking(fd);
+    return fd;
+}
+
+// A non-blocking socket with buffered input and output
+class NetConnection
+{
+public:
+    explicit NetConnection(int fd = -1) : fd(fd) {}
+    NetConnection(const NetConnection &) = delete;
+    NetConnection &operator=(const NetConnection &) = delete;
+    NetConnection(NetConnection &&other) noexcept { *this = std::move(other); }
+    NetConnection &operator=(NetConnection &&other) noexcept
+    {
+        if (this != &other)
+        {
+            closeSocket();
+            fd = other.fd;
+            other.fd = -1;
+            input = std::move(other.input);
+            output = std::move(other.output);
+        }
+        return *this;
+    }
+    ~NetConnection() { closeSocket(); }
+
+    bool isOpen() const { return fd >= 0; }
+    int socket() const { return fd; }
+    size_t pendingOutput() const { return output.size(); }
+
+    // Bytes queued here are sent by flush()
+    std::vector<uint8_t> &outgoing() { return output; }
+
+    // Sends as much queued output as the socket accepts. Returns false if the connection failed.
+    bool flush()
+    {
+        size_t sent = 0;
+        while (sent < output.size())
+        {
+            int flags = 0;
+#ifdef MSG_NOSIGNAL
+            flags = MSG_NOSIGNAL;
+#endif
+            ssize_t result = send(fd, output.data() + sent, output.size() - sent, flags);
+            if (result < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+                output.erase(output.begin(), output.begin() + sent);
+                return false;
+            }
+            sent += (size_t)result;
+        }
+        output.erase(output.begin(), output.begin() + sent);
+        return true;
+    }
+
+    // Reads everything currently available. Returns false once the peer closed or the read failed.
+    bool receive()
+    {
+        uint8_t buffer[64 * 1024];
+        while (true)
+        {
+            ssize_t result = recv(fd, buffer, sizeof(buffer), 0);
+            if (result > 0)
+            {
+                input.insert(input.end(), buffer, buffer + result);
+                continue;
+            }
+            if (result == 0)
+                return false;
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+    }
+
+    // Pops the next complete message from the input buffer. Sets error on a malformed message.
+    bool nextMessage(NetMessage &type, std::vector<uint8_t> &payload, bool &error)
+    {
+        error = false;
+        if (input.size() < NET_HEADER_SIZE)
+            return false;
+        uint32_t length = getU32(&input[1]);
+        if (length > MAX_NET_PAYLOAD)
+        {
+            error = true;
+            return false;
+        }
+        if (input.size() < NET_HEADER_SIZE + length)
+            return false;
+        type = (NetMessage)input[0];
+        payload.assign(input.begin() + NET_HEADER_SIZE, input.begin() + NET_HEADER_SIZE + length);
+        input.erase(input.begin(), input.begin() + NET_HEADER_SIZE + length);
+        return true;
+    }
+
+    void closeSocket()
+    {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+
+private:
+    int fd = -1;
+    std::vector<uint8_t> input;
+    std::vector<uint8_t> output;
+};
+
+#endif // LIFE_NET_AVAILABLE
@@ -0,0 +1,270 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+// Minimal self-contained PNG encoder for 1-bit grayscale images, used by the frame recorder.
+// Compression is a single fixed-Huffman deflate block with LZ77 matching, which is plenty for
+// Game of Life frames (long runs of identical bytes) and avoids a zlib dependency.
+
+inline uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len)
+{
+    static const std::vector<uint32_t> table = []
+    {
+        std::vector<uint32_t> t(256);
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+inline uint32_t adler32(const uint8_t *data, size_t len)
+{
+    uint32_t a = 1, b = 0;
+    while (len > 0)
+    {
+        size_t chunk = len < 5552 ? len : 5552; // Largest run that cannot overflow before the modulo
+        len -= chunk;
+        while (chunk--)
+        {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+inline void putBigEndian32(std::vector<uint8_t> &out, uint32_t value)
+{
+    out.push_back((uint8_t)(value >> 24));
+    out.push_back((uint8_t)(value >> 16));
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)value);
+}
+
+// LSB-first bit writer as required by deflate
+struct DeflateBitWriter
+{
+    std::vector<uint8_t> &out;
+    uint32_t bitBuffer = 0;
+    int bitCount = 0;
+
+    explicit DeflateBitWriter(std::vector<uint8_t> &target) : out(target) {}
+
+    void putBits(uint32_t value, int count)
+    {
+        bitBuffer |= value << bitCount;
+        bitCount += count;
+        while (bitCount >= 8)
+        {
+            out.push_back((uint8_t)bitBuffer);
+            bitBuffer >>= 8;
+            bitCount -= 8;
+        }
+    }
+
+    // Huffman codes are stored most significant bit first
+    void putCode(uint32_t code, int length)
+    {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i)
+            reversed |= ((code >> i) & 1) << (length - 1 - i);
+        putBits(reversed, length);
+    }
+
+    void flush()
+    {
+        if (bitCount > 0)
+            out.push_back((uint8_t)bitBuffer);
+        bitBuffer = 0;
+        bitCount = 0;
+    }
+};
+
+inline void putFixedLiteral(DeflateBitWriter &bits, int symbol)
+{
+    if (symbol < 144)
+        bits.putCode(0x30 + symbol, 8);
+    else if (symbol < 256)
+        bits.putCode(0x190 + (symbol - 144), 9);
+    else if (symbol < 280)
+        bits.putCode(symbol - 256, 7);
+    else
+        bits.putCode(0xC0 + (symbol - 280), 8);
+}
+
+inline void putFixedMatch(DeflateBitWriter &bits, int length, int distance)
+{
+    static const int lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                       35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const int lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const int distBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                     257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                     8193, 12289, 16385, 24577};
+    static const int distExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                      7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    int lc = 28;
+    while (lengthBase[lc] > length)
+        --lc;
+    putFixedLiteral(bits, 257 + lc);
+    bits.putBits(length - lengthBase[lc], lengthExtra[lc]);
+
+    int dc = 29;
+    while (distBase[dc] > distance)
+        --dc;
+    bits.putCode(dc, 5);
+    bits.putBits(distance - distBase[dc], distExtra[dc]);
+}
+
+// Compresses data into a zlib stream (single fixed-Huffman deflate block)
+inline std::vector<uint8_t> zlibCompress(const std::vector<uint8_t> &data)
+{
+    const size_t WINDOW = 32768;
+    const size_t MIN_MATCH = 3;
+    const size_t MAX_MATCH = 258;
+    const int MAX_CHAIN = 16;
+    const int HASH_BITS = 15;
+    const size_t NONE = (size_t)-1;
+
+    std::vector<uint8_t> out = {0x78, 0x01};
+    DeflateBitWriter bits(out);
+    bits.putBits(1, 1); // BFINAL
+    bits.putBits(1, 2); // BTYPE = fixed Huffman
+
+    // Hash chains only reach back one window, so the previous-position links live in a ring the size
+    // of the window instead of one entry per input byte
+    const size_t n = data.size();
+    std::vector<size_t> head((size_t)1 << HASH_BITS, NONE);
+    std::vector<size_t> prev(WINDOW, NONE);
+    auto hashAt = [&](size_t pos)
+    {
+        uint32_t v = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16);
+        return (size_t)((v * 2654435761u) >> (32 - HASH_BITS));
+    };
+    auto insert = [&](size_t pos)
+    {
+        if (pos + MIN_MATCH > n)
+            return;
+        size_t h = hashAt(pos);
+        prev[pos % WINDOW] = head[h];
+        head[h] = pos;
+    };
+
+    size_t i = 0;
+    while (i < n)
+    {
+        size_t bestLength = 0, bestDistance = 0;
+        if (i + MIN_MATCH <= n)
+        {
+            size_t candidate = head[hashAt(i)];
+            size_t maxLength = std::min(MAX_MATCH, n - i);
+            // A candidate within the window still owns its ring slot, so the chain stays valid
+            for (int chain = 0; candidate != NONE && i - candidate <= WINDOW && chain < MAX_CHAIN; ++chain)
+            {
+                size_t length = 0;
+                while (length < maxLength && data[candidate + length] == data[i + length])
+                    ++length;
+                if (length > bestLength)
+                {
+                    bestLength = length;
+                    bestDistance = i - candidate;
+                    if (length == maxLength)
+                        break;
+                }
+                candidate = prev[candidate % WINDOW];
+            }
+        }
+
+        if (bestLength >= MIN_MATCH)
+        {
+            putFixedMatch(bits, (int)bestLength, (int)bestDistance);
+            for (size_t k = 0; k < bestLength; ++k)
+                insert(i + k);
+            i += bestLength;
+        }
+        else
+        {
+            putFixedLiteral(bits, data[i]);
+            insert(i);
+            ++i;
+        }
+    }
+    putFixedLiteral(bits, 256); // End of block
+    bits.flush();
+
+    putBigEndian32(out, adler32(data.data(), data.size()));
+    return out;
+}
+
+// Bytes per row of a 1-bit image, as stored in packed frames and PNG scanlines
+inline size_t packedRowBytes(int width)
+{
+    return ((size_t)width + 7) / 8;
+}
+
+// Compresses a 1-bit image (rows of packedRowBytes(width) bytes, most significant bit first,
+// 1 = white) into filtered PNG scanlines
+inline std::vector<uint8_t> encodePngImageData(const uint8_t *packed, int width, int height)
+{
+    const size_t rowBytes = packedRowBytes(width);
+    std::vector<uint8_t> raw((rowBytes + 1) * (size_t)height, 0);
+    for (int y = 0; y < height; ++y)
+    {
+        uint8_t *row = &raw[(size_t)y * (rowBytes + 1)];
+        row[0] = 0; // Filter type: None
+        std::copy(packed + (size_t)y * rowBytes, packed + (size_t)(y + 1) * rowBytes, row + 1);
+    }
+    return zlibCompress(raw);
+}
+
+inline void writePngChunk(std::ostream &out, const char type[4], const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> header;
+    putBigEndian32(header, (uint32_t)data.size());
+    header.insert(header.end(), type, type + 4);
+    out.write((const char *)header.data(), header.size());
+    if (!data.empty())
+        out.write((const char *)data.data(), data.size());
+
+    uint32_t crc = crc32Update(0, (const uint8_t *)type, 4);
+    crc = crc32Update(crc, data.data(), data.size());
+    std::vector<uint8_t> trailer;
+    putBigEndian32(trailer, crc);
+    out.write((const char *)trailer.data(), trailer.size());
+}
+
+inline void writePngSignature(std::ostream &out)
+{
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.write((const char *)signature, sizeof(signature));
+}
+
+// IHDR for a 1-bit grayscale, non-interlaced image
+inline std::vector<uint8_t> pngHeaderChunk(int width, int height)
+{
+    std::vector<uint8_t> ihdr;
+    putBigEndian32(ihdr, (uint32_t)width);
+    putBigEndian32(ihdr, (uint32_t)height);
+    ihdr.push_back(1); // Bit depth
+    ihdr.push_back(0); // Color type: grayscale
+    ihdr.push_back(0); // Compression
+    ihdr.push_back(0); // Filter
+    ihdr.push_back(0); // Interlace
+    return ihdr;
+}
@@ -1,13 +1,15 @@
 #pragma once
 #include <SDL2/SDL.h>
 #include <vector>
+#include <functional>
 #include <algorithm> // For std::min/max
+#include "grid_memory.h"
 
 const int MIN_CELL_SIZE_FOR_TOGGLE = 8;
 
 struct Grid
 {
-    std::vector<std::vector<bool>> cells;
+    CellBuffer cells;
     int rows;
     int cols;
     int cellSize;
@@ -15,6 +17,39 @@ struct Grid
     int offsetY;
 };
 
+// A rectangle of cells, e.g. the part of the board a window shows
+struct Viewport
+{
+    int top = 0;
+    int left = 0;
+    int height = 0;
+    int width = 0;
+
+    bool empty() const { return height <= 0 || width <= 0; }
+    bool operator==(const Viewport &other) const
+    {
+        return top == other.top && left == other.left && height == other.height && width == other.width;
+    }
+    bool operator!=(const Viewport &other) const { return !(*this == other); }
+};
+
+// A copy of the cells of one viewport of a board, row-major with one byte per cell. The window only
+// ever holds the cells it shows; the board itself lives in the engine (or on the server).
+struct GridRegion
+{
+    Viewport area;
+    std::vector<uint8_t> cells;
+
+    // Takes board coordinates; cells outside the area are dead
+    bool alive(int row, int col) const
+    {
+        row -= area.top;
+        col -= area.left;
+        return row >= 0 && row < area.height && col >= 0 && col < area.width &&
+               cells[(size_t)row * area.width + col];
+    }
+};
+
 struct InputState
 {
     bool rightMouseDown = false;
@@ -75,45 +110,59 @@ inline void panGrid(Grid &grid, int dx, int dy, int windowWidth, int windowHeigh
 // Initialize grid
 inline Grid initGrid(int rows, int cols, int cellSize)
 {
-    return Grid{std::vector<std::vector<bool>>(rows, std::vector<bool>(cols, false)),
-                rows, cols, cellSize, 0, 0};
+    return Grid{CellBuffer(rows, cols), rows, cols, cellSize, 0, 0};
 }
 
-// Clear all cells in the grid
-inline void clearGrid(Grid &grid)
+// The cells of grid visible in a window of the given size
+inline Viewport visibleViewport(const Grid &grid, int windowWidth, int windowHeight)
 {
-    for (int row = 0; row < grid.rows; ++row)
-    {
-        for (int col = 0; col < grid.cols; ++col)
-        {
-            grid.cells[row][col] = false;
-        }
-    }
+    Viewport viewport;
+    if (grid.cellSize <= 0)
+        return viewport;
+    viewport.top = std::max(0, -grid.offsetY / grid.cellSize);
+    viewport.left = std::max(0, -grid.offsetX / grid.cellSize);
+    int bottom = std::min(grid.rows, (windowHeight - grid.offsetY) / grid.cellSize + 1);
+    int right = std::min(grid.cols, (windowWidth - grid.offsetX) / grid.cellSize + 1);
+    viewport.height = std::max(0, bottom - viewport.top);
+    viewport.width = std::max(0, right - viewport.left);
+    return viewport;
 }
 
-// Toggle cell at position
-inline void toggleCell(Grid &grid, int x, int y)
+// Finds the board cell under a window position. Returns false if there is none, or if the cells
+// are too small to edit reliably.
+inline bool cellAt(const Grid &grid, int x, int y, int &row, int &col)
 {
-    // Do not allow toggling if zoomed out too far
     if (grid.cellSize < MIN_CELL_SIZE_FOR_TOGGLE)
-        return;
-
-    int col = x / grid.cellSize;
-    int row = y / grid.cellSize;
-    if (row >= 0 && row < grid.rows && col >= 0 && col < grid.cols)
-        grid.cells[row][col] = !grid.cells[row][col];
+        return false;
+    x -= grid.offsetX;
+    y -= grid.offsetY;
+    if (x < 0 || y < 0)
+        return false;
+    col = x / grid.cellSize;
+    row = y / grid.cellSize;
+    return row < grid.rows && col < grid.cols;
 }
 
-// Render the grid
-inline void renderGrid(SDL_Renderer *renderer, const Grid &grid, bool showCenterMarker)
+// Render the grid. grid gives the camera and board size, region the cells to draw (normally the
+// visibleViewport()); cells outside region are drawn dead.
+inline void renderGrid(SDL_Renderer *renderer, const Grid &grid, const GridRegion &region, bool showCenterMarker)
 {
+    // Only visit the rows and columns that are on screen, so large boards cost no more to draw than small ones
+    int outputW, outputH;
+    if (SDL_GetRendererOutputSize(renderer, &outputW, &outputH) != 0 || grid.cellSize <= 0)
+        return;
+    int firstRow = std::max(0, -grid.offsetY / grid.cellSize);
+    int lastRow = std::min(grid.rows - 1, (outputH - grid.offsetY) / grid.cellSize);
+    int firstCol = std::max(0, -grid.offsetX / grid.cellSize);
+    int lastCol = std::min(grid.cols - 1, (outputW - grid.offsetX) / grid.cellSize);
+
     // Draw cells
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    for (int row = 0; row < grid.rows; row++)
+    for (int row = firstRow; row <= lastRow; row++)
     {
-        for (int col = 0; col < grid.cols; col++)
+        for (int col = firstCol; col <= lastCol; col++)
         {
-            if (grid.cells[row][col])
+            if (region.alive(row, col))
             {
                 SDL_Rect cellRect = {col * grid.cellSize + grid.offsetX,
                                      row * grid.cellSize + grid.offsetY,
@@ -127,13 +176,19 @@ inline void renderGrid(SDL_Renderer *renderer, const Grid &grid, bool showCenter
     if (grid.cellSize >= 4)
     {
         SDL_SetRenderDrawColor(renderer, 200, 200, 200, 200); // Light gray for grid lines
-        for (int x = 0; x <= grid.cols * grid.cellSize; x += grid.cellSize)
+        for (int col = firstCol; col <= lastCol + 1 && col <= grid.cols; col++)
+        {
+            int x = col * grid.cellSize;
             SDL_RenderDrawLine(renderer, x + grid.offsetX, 0 + grid.offsetY,
                                x + grid.offsetX, grid.rows * grid.cellSize + grid.offsetY);
+        }
 
-        for (int y = 0; y <= grid.rows * grid.cellSize; y += grid.cellSize)
+        for (int row = firstRow; row <= lastRow + 1 && row <= grid.rows; row++)
+        {
+            int y = row * grid.cellSize;
             SDL_RenderDrawLine(renderer, 0 + grid.offsetX, y + grid.offsetY,
                                grid.cols * grid.cellSize + grid.offsetX, y + grid.offsetY);
+        }
     }
 
     // Draw center marker
@@ -147,15 +202,19 @@ inline void renderGrid(SDL_Renderer *renderer, const Grid &grid, bool showCenter
     }
 }
 
-// Handle mouse and touch events for pre-game (placing cells + panning)
-inline void handlePreGameEvent(SDL_Event &event, Grid &grid, InputState &input, SDL_Window *window, bool allowToggle)
+// Handle mouse and touch events for pre-game (placing cells + panning). toggleCell is called with
+// the row and column of a clicked cell; leave it empty where cells cannot be edited.
+inline void handlePreGameEvent(SDL_Event &event, Grid &grid, InputState &input, SDL_Window *window,
+                               const std::function<void(int, int)> &toggleCell)
 {
+    int row, col;
     switch (event.type)
     {
     case SDL_MOUSEBUTTONDOWN:
-        if (allowToggle && event.button.button == SDL_BUTTON_LEFT)
+        if (toggleCell && event.button.button == SDL_BUTTON_LEFT)
         {
-            toggleCell(grid, event.button.x - grid.offsetX, event.button.y - grid.offsetY);
+            if (cellAt(grid, event.button.x, event.button.y, row, col))
+                toggleCell(row, col);
         }
         else if (event.button.button == SDL_BUTTON_RIGHT)
         {
@@ -190,11 +249,12 @@ inline void handlePreGameEvent(SDL_Event &event, Grid &grid, InputState &input,
         input.startFingerY = input.lastFingerY = event.tfinger.y;
         break;
     case SDL_FINGERUP:
-        if (allowToggle && !input.isPanning && !input.inMultiGesture)
+        if (toggleCell && !input.isPanning && !input.inMultiGesture)
         {
             int w, h;
             SDL_GetWindowSize(window, &w, &h);
-            toggleCell(grid, input.startFingerX * w - grid.offsetX, input.startFingerY * h - grid.offsetY);
+            if (cellAt(grid, input.startFingerX * w, input.startFingerY * h, row, col))
+                toggleCell(row, col);
         }
         input.fingerDown = false;
         input.isPanning = false;
@@ -0,0 +1,464 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include "pre_game.h" // For Grid struct
+#include "life_engine.h"
+#include "png_writer.h"
+
+enum class RecordFormat
+{
+    PNG_SEQUENCE,
+    APNG,
+    Y4M
+};
+
+enum class RecordScope
+{
+    BOARD,   // One pixel per cell, whole board
+    VIEWPORT // What is visible in the window, at screen resolution
+};
+
+// What to do with a captured frame when the encoder has fallen behind
+enum class QueuePolicy
+{
+    DROP, // Discard the new frame, never slow down the simulation
+    BLOCK // Wait for the encoder (backpressure), never lose a frame
+};
+
+struct RecordSettings
+{
+    std::string basePath = "recording";
+    RecordFormat format = RecordFormat::PNG_SEQUENCE;
+    RecordScope scope = RecordScope::BOARD;
+    QueuePolicy policy = QueuePolicy::DROP;
+    int everyNth = 1;      // Capture every Nth generation
+    int queueCapacity = 8; // Frames buffered between capture and encoder
+    int fps = 10;          // Playback rate of APNG and Y4M output
+};
+
+// A bitmap of one generation. PNG output is 1 bit per pixel, so its frames are captured packed
+// (rows of packedRowBytes(width) bytes, most significant bit first, 1 = live) at an eighth of the
+// memory; Y4M frames are 8-bit luma (0 = dead, 255 = live).
+struct Frame
+{
+    int width = 0;
+    int height = 0;
+    long long generation = 0;
+    bool packed = false;
+    std::vector<uint8_t> pixels;
+
+    size_t rowBytes() const { return packed ? packedRowBytes(width) : (size_t)width; }
+
+    void setPixel(int x, int y)
+    {
+        if (packed)
+            pixels[(size_t)y * rowBytes() + x / 8] |= (uint8_t)(0x80 >> (x % 8));
+        else
+            pixels[(size_t)y * width + x] = 255;
+    }
+};
+
+// Bounded single-producer/single-consumer queue between the simulation and the encoder thread
+class FrameQueue
+{
+public:
+    explicit FrameQueue(size_t capacity) : capacity(capacity > 0 ? capacity : 1) {}
+
+    // Returns false if the frame was dropped (queue full under DROP policy, or queue closed)
+    bool push(Frame &&frame, QueuePolicy policy)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (policy == QueuePolicy::BLOCK)
+            notFull.wait(lock, [this] { return closed || frames.size() < capacity; });
+        if (closed || frames.size() >= capacity)
+            return false;
+        frames.push_back(std::move(frame));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // Blocks until a frame is available. Returns false once the queue is closed and drained.
+    bool pop(Frame &frame)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] { return closed || !frames.empty(); });
+        if (frames.empty())
+            return false;
+        frame = std::move(frames.front());
+        frames.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+private:
+    size_t capacity;
+    bool closed = false;
+    std::deque<Frame> frames;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+};
+
+// Output container for recorded frames
+class FrameEncoder
+{
+public:
+    virtual ~FrameEncoder() = default;
+    virtual bool write(const Frame &frame) = 0;
+    virtual void finish() {}
+};
+
+// One numbered PNG file per frame: <base>_<generation>.png
+class PngSequenceEncoder : public FrameEncoder
+{
+public:
+    explicit PngSequenceEncoder(const std::string &basePath) : basePath(basePath) {}
+
+    bool write(const Frame &frame) override
+    {
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), "_%08lld.png", frame.generation);
+        std::ofstream out(basePath + suffix, std::ios::binary);
+        if (!out.is_open())
+            return false;
+        writePngSignature(out);
+        writePngChunk(out, "IHDR", pngHeaderChunk(frame.width, frame.height));
+        writePngChunk(out, "IDAT", encodePngImageData(frame.pixels.data(), frame.width, frame.height));
+        writePngChunk(out, "IEND", {});
+        return out.good();
+    }
+
+private:
+    std::string basePath;
+};
+
+// Single animated PNG: <base>.png. The frame count in acTL is patched in by finish().
+class ApngEncoder : public FrameEncoder
+{
+public:
+    ApngEncoder(const std::string &basePath, int fps) : path(basePath + ".png"), fps(fps > 0 ? fps : 10) {}
+
+    bool write(const Frame &frame) override
+    {
+        if (frameCount == 0)
+        {
+            out.open(path, std::ios::binary);
+            if (!out.is_open())
+                return false;
+            width = frame.width;
+            height = frame.height;
+            writePngSignature(out);
+            writePngChunk(out, "IHDR", pngHeaderChunk(width, height));
+            acTLPosition = out.tellp();
+            writePngChunk(out, "acTL", animationControl(0));
+        }
+        else if (frame.width != width || frame.height != height)
+        {
+            return false; // All APNG frames must match the canvas size
+        }
+
+        std::vector<uint8_t> fcTL;
+        putBigEndian32(fcTL, sequence++);
+        putBigEndian32(fcTL, (uint32_t)width);
+        putBigEndian32(fcTL, (uint32_t)height);
+        putBigEndian32(fcTL, 0); // x offset
+        putBigEndian32(fcTL, 0); // y offset
+        fcTL.push_back(0);       // delay numerator (16 bit): 1
+        fcTL.push_back(1);
+        fcTL.push_back((uint8_t)(fps >> 8)); // delay denominator (16 bit): fps
+        fcTL.push_back((uint8_t)fps);
+        fcTL.push_back(0); // dispose: none
+        fcTL.push_back(0); // blend: source
+        writePngChunk(out, "fcTL", fcTL);
+
+        std::vector<uint8_t> data = encodePngImageData(frame.pixels.data(), width, height);
+        if (frameCount == 0)
+        {
+            writePngChunk(out, "IDAT", data);
+        }
+        else
+        {
+            std::vector<uint8_t> fdAT;
+            putBigEndian32(fdAT, sequence++);
+            fdAT.insert(fdAT.end(), data.begin(), data.end());
+            writePngChunk(out, "fdAT", fdAT);
+        }
+        ++frameCount;
+        return out.good();
+    }
+
+    void finish() override
+    {
+        if (!out.is_open())
+            return;
+        writePngChunk(out, "IEND", {});
+        out.seekp(acTLPosition);
+        writePngChunk(out, "acTL", animationControl(frameCount));
+        out.close();
+    }
+
+private:
+    std::vector<uint8_t> animationControl(uint32_t frames) const
+    {
+        std::vector<uint8_t> acTL;
+        putBigEndian32(acTL, frames);
+        putBigEndian32(acTL, 0); // Loop forever
+        return acTL;
+    }
+
+    std::string path;
+    int fps;
+    std::ofstream out;
+    std::streampos acTLPosition;
+    uint32_t sequence = 0;
+    uint32_t frameCount = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Raw YUV4MPEG2 video: <base>.y4m, 4:2:0 with neutral chroma
+class Y4mEncoder : public FrameEncoder
+{
+public:
+    Y4mEncoder(const std::string &basePath, int fps) : path(basePath + ".y4m"), fps(fps > 0 ? fps : 10) {}
+
+    bool write(const Frame &frame) override
+    {
+        if (!out.is_open())
+        {
+            out.open(path, std::ios::binary);
+            if (!out.is_open())
+                return false;
+            width = frame.width;
+            height = frame.height;
+            out << "YUV4MPEG2 W" << width << " H" << height << " F" << fps << ":1 Ip A1:1 C420jpeg\n";
+            chroma.assign((size_t)((width + 1) / 2) * ((height + 1) / 2) * 2, 128);
+        }
+        else if (frame.width != width || frame.height != height)
+        {
+            return false; // Y4M streams have a fixed frame size
+        }
+
+        out << "FRAME\n";
+        out.write((const char *)frame.pixels.data(), frame.pixels.size());
+        out.write((const char *)chroma.data(), chroma.size());
+        return out.good();
+    }
+
+    void finish() override
+    {
+        if (out.is_open())
+            out.close();
+    }
+
+private:
+    std::string path;
+    int fps;
+    std::ofstream out;
+    std::vector<uint8_t> chroma;
+    int width = 0;
+    int height = 0;
+};
+
+inline std::unique_ptr<FrameEncoder> createFrameEncoder(const RecordSettings &settings)
+{
+    switch (settings.format)
+    {
+    case RecordFormat::APNG:
+        return std::unique_ptr<FrameEncoder>(new ApngEncoder(settings.basePath, settings.fps));
+    case RecordFormat::Y4M:
+        return std::unique_ptr<FrameEncoder>(new Y4mEncoder(settings.basePath, settings.fps));
+    case RecordFormat::PNG_SEQUENCE:
+    default:
+        return std::unique_ptr<FrameEncoder>(new PngSequenceEncoder(settings.basePath));
+    }
+}
+
+// Captures every Nth generation on the simulation thread and hands the bitmap to a background
+// encoder thread through a bounded queue, so encoding and disk I/O never run inside the step loop.
+class Recorder
+{
+public:
+    Recorder() = default;
+    Recorder(const Recorder &) = delete;
+    Recorder &operator=(const Recorder &) = delete;
+    ~Recorder() { stop(); }
+
+    bool active() const { return queue != nullptr; }
+    long long framesWritten() const { return written; }
+    long long framesDropped() const { return dropped; }
+
+    void start(const RecordSettings &newSettings)
+    {
+        stop();
+        settings = newSettings;
+        if (settings.everyNth < 1)
+            settings.everyNth = 1;
+        written = 0;
+        dropped = 0;
+        failed = 0;
+        frameWidth = frameHeight = 0;
+        queue.reset(new FrameQueue(settings.queueCapacity));
+        encoder = createFrameEncoder(settings);
+        worker = std::thread([this] { encodeLoop(); });
+        std::cout << "Recording started: " << settings.basePath << std::endl;
+    }
+
+    // Flushes the queued frames and finalizes the output
+    void stop()
+    {
+        if (!queue)
+            return;
+        queue->close();
+        worker.join();
+        encoder->finish();
+        encoder.reset();
+        queue.reset();
+        std::cout << "Recording stopped: " << written << " frames written, " << dropped << " dropped";
+        if (failed > 0)
+            std::cout << ", " << failed << " failed";
+        std::cout << std::endl;
+    }
+
+    // Called after each generation with the engine holding the board. camera is the window's view of
+    // it and viewWidth/viewHeight the window size, used for VIEWPORT scope; the frame size is fixed by
+    // the first captured frame.
+    void capture(const LifeEngine &engine, const Grid &camera, long long generation, int viewWidth, int viewHeight)
+    {
+        if (!queue || generation % settings.everyNth != 0)
+            return;
+
+        if (frameWidth == 0)
+        {
+            frameWidth = (settings.scope == RecordScope::BOARD) ? engine.cols() : viewWidth;
+            frameHeight = (settings.scope == RecordScope::BOARD) ? engine.rows() : viewHeight;
+        }
+        if (frameWidth <= 0 || frameHeight <= 0)
+            return;
+
+        Frame frame;
+        frame.width = frameWidth;
+        frame.height = frameHeight;
+        frame.generation = generation;
+        frame.packed = (settings.format != RecordFormat::Y4M);
+        frame.pixels.assign(frame.rowBytes() * frameHeight, 0);
+        if (settings.scope == RecordScope::BOARD)
+            captureBoard(engine, frame);
+        else
+            captureViewport(engine, camera, frame);
+
+        if (!queue->push(std::move(frame), settings.policy))
+            ++dropped;
+    }
+
+private:
+    // Exports the board a band of rows at a time, so a frame never needs a second full-size copy of
+    // the board next to the engine's
+    static void captureBoard(const LifeEngine &engine, Frame &frame)
+    {
+        const long long BAND_CELLS = 1 << 20;
+        int rows = std::min(engine.rows(), frame.height);
+        int cols = std::min(engine.cols(), frame.width);
+        if (cols <= 0)
+            return;
+        int bandRows = (int)std::max(1LL, BAND_CELLS / cols);
+        std::vector<uint8_t> band;
+        for (int top = 0; top < rows; top += bandRows)
+        {
+            int height = std::min(bandRows, rows - top);
+            engine.exportRegion(top, 0, height, cols, band);
+            for (int r = 0; r < height; ++r)
+                packRow(&band[(size_t)r * cols], cols, frame.packed, &frame.pixels[(size_t)(top + r) * frame.rowBytes()]);
+        }
+    }
+
+    static void packRow(const uint8_t *cells, int cols, bool packed, uint8_t *dst)
+    {
+        if (!packed)
+        {
+            for (int col = 0; col < cols; ++col)
+                dst[col] = cells[col] ? 255 : 0;
+            return;
+        }
+        // Eight cells per output byte
+        int col = 0;
+        for (; col + 8 <= cols; col += 8)
+        {
+            uint8_t byte = 0;
+            for (int bit = 0; bit < 8; ++bit)
+                byte = (uint8_t)((byte << 1) | (cells[col + bit] != 0));
+            dst[col / 8] = byte;
+        }
+        for (; col < cols; ++col)
+        {
+            if (cells[col])
+                dst[col / 8] |= (uint8_t)(0x80 >> (col % 8));
+        }
+    }
+
+    // Samples the visible cells at screen resolution, without grid lines or markers
+    static void captureViewport(const LifeEngine &engine, const Grid &camera, Frame &frame)
+    {
+        GridRegion region;
+        region.area = visibleViewport(camera, frame.width, frame.height);
+        engine.exportRegion(region.area.top, region.area.left, region.area.height, region.area.width, region.cells);
+
+        std::vector<int> columnOf(frame.width);
+        for (int x = 0; x < frame.width; ++x)
+        {
+            int dx = x - camera.offsetX;
+            columnOf[x] = (dx >= 0) ? dx / camera.cellSize : -1;
+        }
+        for (int y = 0; y < frame.height; ++y)
+        {
+            int dy = y - camera.offsetY;
+            int row = (dy >= 0) ? dy / camera.cellSize : -1;
+            if (row < 0)
+                continue;
+            for (int x = 0; x < frame.width; ++x)
+            {
+                if (columnOf[x] >= 0 && region.alive(row, columnOf[x]))
+                    frame.setPixel(x, y);
+            }
+        }
+    }
+
+    void encodeLoop()
+    {
+        Frame frame;
+        while (queue->pop(frame))
+        {
+            if (encoder->write(frame))
+                ++written;
+            else
+                ++failed;
+        }
+    }
+
+    RecordSettings settings;
+    std::unique_ptr<FrameQueue> queue;
+    std::unique_ptr<FrameEncoder> encoder;
+    std::thread worker;
+    std::atomic<long long> written{0};
+    std::atomic<long long> dropped{0};
+    std::atomic<long long> failed{0};
+    int frameWidth = 0;
+    int frameHeight = 0;
+};
@@ -2,11 +2,32 @@
 #include <SDL2/SDL.h>
 #include "ui.hpp"
 #include "file_io.h"
+#include "recorder.h"
+#include "engine_factory.h"
 
-// Renders the settings menu
-inline void renderSettings(SDL_Renderer* renderer, TTF_Font* font, 
+// Updates the file name field label, showing a cursor while it is being edited
+inline void updateFileNameLabel(Button& fileNameField, const std::string& saveFilePath, bool editing)
+{
+    fileNameField.text = "File: " + saveFilePath + (editing ? "_" : "");
+}
+
+// Ends editing of the file name field, however it was left, falling back to the default name if
+// the field was cleared
+inline void stopEditingFileName(std::string& saveFilePath, bool& editingFileName, Button& fileNameField)
+{
+    editingFileName = false;
+    SDL_StopTextInput();
+    if (saveFilePath.empty()) saveFilePath = DEFAULT_SAVE_FILE;
+    updateFileNameLabel(fileNameField, saveFilePath, editingFileName);
+}
+
+// Renders the settings menu. A viewer only gets the view options: its board lives on the server,
+// so there is nothing to import, export, record or hand to another engine.
+inline void renderSettings(SDL_Renderer* renderer, TTF_Font* font,
                          Button& invertScrollCheckbox, Button& showCenterCheckbox,
-                         Button& importButton, Button& exportButton)
+                         Button& fileNameField, Button& importButton, Button& exportButton,
+                         Button& cancelButton, const GridFileJob& fileJob, Button& recordCheckbox,
+                         Button& engineButton, bool viewerMode)
 {
     // Clear screen to a dark blue
     SDL_SetRenderDrawColor(renderer, 20, 20, 40, 255);
@@ -15,19 +36,42 @@ inline void renderSettings(SDL_Renderer* renderer, TTF_Font* font,
     // Draw the controls
     invertScrollCheckbox.draw(renderer, font);
     showCenterCheckbox.draw(renderer, font);
+    if (viewerMode) return;
+    fileNameField.draw(renderer, font);
     importButton.draw(renderer, font);
     exportButton.draw(renderer, font);
+    recordCheckbox.draw(renderer, font);
+    engineButton.draw(renderer, font);
+
+    // Progress bar and cancel button while an import/export runs in the background
+    if (fileJob.busy()) {
+        cancelButton.draw(renderer, font);
+
+        SDL_Rect outline = {importButton.rect.x, importButton.rect.y + importButton.rect.h + 20,
+                            cancelButton.rect.x + cancelButton.rect.w - importButton.rect.x, 20};
+        SDL_Rect fill = outline;
+        fill.w = (int)(outline.w * fileJob.fraction());
+        SDL_SetRenderDrawColor(renderer, 80, 160, 255, 255);
+        SDL_RenderFillRect(renderer, &fill);
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderDrawRect(renderer, &outline);
+    }
 }
 
-// Handles events specifically for the settings menu
-inline void handleSettingsEvent(SDL_Event& event, Grid& grid,
-                              bool& invertMouseScrolling, Button& invertScrollCheckbox, 
+// Handles events specifically for the settings menu. In viewer mode only the view options respond.
+inline void handleSettingsEvent(SDL_Event& event, long long generation, bool viewerMode,
+                              bool& invertMouseScrolling, Button& invertScrollCheckbox,
                               bool& showCenterMarker, Button& showCenterCheckbox,
-                              Button& importButton, Button& exportButton,
+                              std::string& saveFilePath, bool& editingFileName, Button& fileNameField,
+                              Button& importButton, Button& exportButton, Button& cancelButton,
+                              GridFileJob& fileJob,
+                              Recorder& recorder, const RecordSettings& recordSettings, Button& recordCheckbox,
+                              std::string& engineName, const std::string& crossCheckEngine,
+                              std::unique_ptr<LifeEngine>& engine, Button& engineButton,
                               std::string& statusMessage, Uint32& statusMessageTimeout)
 {
     if (event.type != SDL_MOUSEBUTTONDOWN && event.type != SDL_FINGERUP) return;
-    
+
     int mouseX, mouseY;
     SDL_GetMouseState(&mouseX, &mouseY);
 
@@ -41,21 +85,121 @@ inline void handleSettingsEvent(SDL_Event& event, Grid& grid,
         showCenterCheckbox.text = showCenterMarker ? "[X] Show Grid Center" : "[ ] Show Grid Center";
     }
 
-    if (importButton.isClicked(mouseX, mouseY)) {
-        if (importGrid(grid, "grid_save.txt")) {
-            statusMessage = "Grid imported successfully!";
+    if (viewerMode) return;
+
+    // Clicking the file name field starts editing, clicking anywhere else ends it
+    if (editingFileName) {
+        stopEditingFileName(saveFilePath, editingFileName, fileNameField);
+    } else if (fileNameField.isClicked(mouseX, mouseY)) {
+        editingFileName = true;
+        SDL_StartTextInput();
+        updateFileNameLabel(fileNameField, saveFilePath, editingFileName);
+    }
+
+    if (recordCheckbox.isClicked(mouseX, mouseY)) {
+        if (recorder.active()) {
+            recorder.stop();
+            statusMessage = "Recording stopped: " + std::to_string(recorder.framesWritten()) + " frames written, " +
+                            std::to_string(recorder.framesDropped()) + " dropped.";
         } else {
-            statusMessage = "Error: Failed to import grid.";
+            recorder.start(recordSettings);
+            statusMessage = "Recording to " + recordSettings.basePath + "...";
+        }
+        recordCheckbox.text = recorder.active() ? "[X] Record Frames" : "[ ] Record Frames";
+        statusMessageTimeout = SDL_GetTicks() + 4000; // Show for 4 seconds
+    }
+
+    // Cycle through the available engines, carrying the board and generation over to the new one
+    if (engineButton.isClicked(mouseX, mouseY)) {
+        std::string nextName = nextEngineName(engineName);
+        std::unique_ptr<LifeEngine> nextEngine = createEngine(nextName, crossCheckEngine);
+        try {
+            Grid board{};
+            engine->exportCells(board);
+            nextEngine->importCells(board);
+            nextEngine->setGeneration(generation);
+            engine = std::move(nextEngine);
+            engineName = nextName;
+            engineButton.text = "Engine: " + engine->name();
+        } catch (const std::bad_alloc&) {
+            statusMessage = "Error: Not enough memory to switch engines.";
+            statusMessageTimeout = SDL_GetTicks() + 4000; // Show for 4 seconds
         }
+    }
+
+    if (fileJob.busy()) {
+        if (cancelButton.isClicked(mouseX, mouseY)) {
+            fileJob.cancel();
+        } else if (importButton.isClicked(mouseX, mouseY) || exportButton.isClicked(mouseX, mouseY)) {
+            statusMessage = "Please wait for the current import/export to finish.";
+            statusMessageTimeout = SDL_GetTicks() + 4000; // Show for 4 seconds
+        }
+        return;
+    }
+
+    if (importButton.isClicked(mouseX, mouseY)) {
+        fileJob.startImport(saveFilePath);
+        statusMessage = "Importing grid from " + saveFilePath + "...";
         statusMessageTimeout = SDL_GetTicks() + 4000; // Show for 4 seconds
     }
 
     if (exportButton.isClicked(mouseX, mouseY)) {
-        if (exportGrid(grid, "grid_save.txt")) {
-            statusMessage = "Grid exported successfully!";
+        bool started = false;
+        try {
+            Grid board{};
+            engine->exportCells(board); // The writer thread gets its own copy of the board
+            started = fileJob.startExport(std::move(board), saveFilePath, generation);
+        } catch (const std::bad_alloc&) {
+            std::cerr << "Error: Not enough memory to snapshot the grid for export." << std::endl;
+        }
+        if (started) {
+            statusMessage = "Exporting grid to " + saveFilePath + "...";
         } else {
             statusMessage = "Error: Failed to export grid.";
         }
         statusMessageTimeout = SDL_GetTicks() + 4000; // Show for 4 seconds
     }
 }
+
+// Handles keyboard input while the file name field is being edited
+inline void handleSettingsTextEvent(SDL_Event& event, std::string& saveFilePath,
+                                    bool& editingFileName, Button& fileNameField)
+{
+    if (!editingFileName) return;
+
+    if (event.type == SDL_TEXTINPUT) {
+        saveFilePath += event.text.text;
+    } else if (event.type == SDL_KEYDOWN) {
+        SDL_Keycode key = event.key.keysym.sym;
+        if (key == SDLK_BACKSPACE && !saveFilePath.empty()) {
+            saveFilePath.pop_back();
+        } else if (key == SDLK_RETURN || key == SDLK_KP_ENTER || key == SDLK_ESCAPE) {
+            stopEditingFileName(saveFilePath, editingFileName, fileNameField);
+            return;
+        } else {
+            return;
+        }
+    } else {
+        return;
+    }
+    updateFileNameLabel(fileNameField, saveFilePath, editingFileName);
+}
+
+// Reports a finished background import/export in the status line
+inline void reportFileJobResult(GridFileJob::Kind kind, GridFileJob::Result result,
+                                std::string& statusMessage, Uint32& statusMessageTimeout)
+{
+    bool isImport = (kind == GridFileJob::Kind::IMPORT);
+    switch (result) {
+    case GridFileJob::Result::SUCCESS:
+        statusMessage = isImport ? "Grid imported successfully!" : "Grid exported successfully!";
+        break;
+    case GridFileJob::Result::CANCELLED:
+        statusMessage = isImport ? "Import cancelled." : "Export cancelled.";
+        break;
+    case GridFileJob::Result::FAILED:
+        statusMessage = isImport ? "Error: Failed to import grid." : "Error: Failed to export grid.";
+        break;
+    }
+    statusMessageTimeout = SDL_GetTicks() + 4000; // Show for 4 seconds
+}
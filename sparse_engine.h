@@ -0,0 +1,296 @@
+#pragma once
+#include <vector>
+#include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include "life_engine.h"
+#include "block_engine.h"
+
+// Engine for very sparse boards. It keeps the set of live cells and a hash map of neighbour counts
+// for every cell with at least one live neighbour. A cell can only change state if it or one of its
+// neighbours changed in the previous generation, so each step only visits the cells around the
+// births and deaths of the last one: the cost follows the amount of change, not the board area or
+// population. Above engineConfig().sparseDensityThreshold the board is handed to a BlockEngine,
+// and handed back once it thins out again.
+class SparseEngine : public LifeEngine
+{
+public:
+    std::string name() const override { return "sparse"; }
+    int rows() const override { return numRows; }
+    int cols() const override { return numCols; }
+
+    bool usingDenseKernel() const { return denseMode; }
+
+    void step(int generations) override
+    {
+        for (int g = 0; g < generations; ++g)
+        {
+            if (denseMode)
+            {
+                dense.step(1);
+                if (++generationsSinceCheck >= DENSE_CHECK_INTERVAL)
+                {
+                    generationsSinceCheck = 0;
+                    if (dense.population() < switchBackPopulation())
+                        switchToSparse();
+                }
+            }
+            else
+            {
+                stepSparse();
+                if ((long long)live.size() > switchToDensePopulation())
+                    switchToDense();
+            }
+        }
+    }
+
+    bool getCell(int row, int col) const override
+    {
+        if (denseMode)
+            return dense.getCell(row, col);
+        return inBounds(row, col) && live.count(keyOf(row, col)) > 0;
+    }
+
+    void setCell(int row, int col, bool alive) override
+    {
+        if (denseMode)
+        {
+            dense.setCell(row, col, alive);
+            return;
+        }
+        if (!inBounds(row, col) || getCell(row, col) == alive)
+            return;
+        if (alive)
+            birth(keyOf(row, col));
+        else
+            death(keyOf(row, col));
+        changed.push_back(keyOf(row, col));
+    }
+
+    void reset(int rows, int cols) override
+    {
+        numRows = rows;
+        numCols = cols;
+        clearSparse();
+        denseMode = false;
+        dense.reset(0, 0); // Release the dense buffers
+    }
+
+    void importCells(const Grid &grid) override
+    {
+        numRows = grid.rows;
+        numCols = grid.cols;
+        long long population = 0;
+        for (int row = 0; row < numRows; ++row)
+        {
+            const uint8_t *cells = grid.cells[row];
+            for (int col = 0; col < numCols; ++col)
+                population += cells[col];
+        }
+
+        clearSparse();
+        denseMode = false; // An empty sparse board, should the dense import fail
+        if (population > switchToDensePopulation())
+        {
+            dense.importCells(grid);
+            denseMode = true;
+            generationsSinceCheck = 0;
+            return;
+        }
+
+        dense.reset(0, 0); // Release the dense buffers
+        loadSparse(grid);
+    }
+
+    void exportCells(Grid &grid) const override
+    {
+        if (denseMode)
+        {
+            dense.exportCells(grid);
+            return;
+        }
+        if (grid.cells.rows() != numRows || grid.cells.cols() != numCols)
+            grid.cells.reset(numRows, numCols);
+        else
+            grid.cells.clear();
+        grid.rows = numRows;
+        grid.cols = numCols;
+        for (uint64_t key : live)
+            grid.cells[rowOf(key)][colOf(key)] = 1;
+    }
+
+    void exportRegion(int top, int left, int height, int width, std::vector<uint8_t> &out) const override
+    {
+        if (denseMode)
+        {
+            dense.exportRegion(top, left, height, width, out);
+            return;
+        }
+        // Visit whichever is smaller: the live cells or the cells of the region
+        long long area = (long long)std::max(height, 0) * std::max(width, 0);
+        if ((long long)live.size() >= area)
+        {
+            LifeEngine::exportRegion(top, left, height, width, out);
+            return;
+        }
+        out.assign((size_t)area, 0);
+        for (uint64_t key : live)
+        {
+            int row = rowOf(key) - top, col = colOf(key) - left;
+            if (row >= 0 && row < height && col >= 0 && col < width)
+                out[(size_t)row * width + col] = 1;
+        }
+    }
+
+    long long population() const override
+    {
+        return denseMode ? dense.population() : (long long)live.size();
+    }
+
+    BoundingBox boundingBox() const override
+    {
+        if (denseMode)
+            return dense.boundingBox();
+        BoundingBox box;
+        for (uint64_t key : live)
+            extendBoundingBox(box, rowOf(key), colOf(key));
+        return box;
+    }
+
+private:
+    // How often the dense kernel re-checks the population, since counting it costs a pass over the board
+    static const int DENSE_CHECK_INTERVAL = 8;
+
+    static uint64_t keyOf(int row, int col) { return ((uint64_t)(uint32_t)row << 32) | (uint32_t)col; }
+    static int rowOf(uint64_t key) { return (int)(key >> 32); }
+    static int colOf(uint64_t key) { return (int)(uint32_t)key; }
+
+    bool inBounds(int row, int col) const { return row >= 0 && row < numRows && col >= 0 && col < numCols; }
+
+    long long switchToDensePopulation() const
+    {
+        return (long long)(engineConfig().sparseDensityThreshold * (double)numRows * (double)numCols);
+    }
+
+    // Hysteresis so boards near the threshold do not flip between kernels every few generations
+    long long switchBackPopulation() const { return switchToDensePopulation() / 4; }
+
+    // Calls fn(key) for every in-bounds neighbour of the cell
+    template <typename Fn>
+    void forEachNeighbour(uint64_t key, Fn fn) const
+    {
+        int row = rowOf(key), col = colOf(key);
+        for (int r = std::max(row - 1, 0); r <= std::min(row + 1, numRows - 1); ++r)
+            for (int c = std::max(col - 1, 0); c <= std::min(col + 1, numCols - 1); ++c)
+                if (r != row || c != col)
+                    fn(keyOf(r, c));
+    }
+
+    void birth(uint64_t key)
+    {
+        live.insert(key);
+        forEachNeighbour(key, [this](uint64_t neighbour) { ++counts[neighbour]; });
+    }
+
+    void death(uint64_t key)
+    {
+        live.erase(key);
+        forEachNeighbour(key, [this](uint64_t neighbour)
+                         {
+                             auto it = counts.find(neighbour);
+                             if (--it->second == 0)
+                                 counts.erase(it);
+                         });
+    }
+
+    void stepSparse()
+    {
+        // Only cells that changed last generation, and their neighbours, can change now
+        candidates.clear();
+        for (uint64_t key : changed)
+        {
+            candidates.push_back(key);
+            forEachNeighbour(key, [this](uint64_t neighbour) { candidates.push_back(neighbour); });
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        // Decide every transition against the current state before applying any of them
+        births.clear();
+        deaths.clear();
+        for (uint64_t key : candidates)
+        {
+            auto it = counts.find(key);
+            int neighbours = (it != counts.end()) ? it->second : 0;
+            bool alive = live.count(key) > 0;
+            if (alive && neighbours != 2 && neighbours != 3)
+                deaths.push_back(key);
+            else if (!alive && neighbours == 3)
+                births.push_back(key);
+        }
+
+        for (uint64_t key : births)
+            birth(key);
+        for (uint64_t key : deaths)
+            death(key);
+
+        changed.swap(births);
+        changed.insert(changed.end(), deaths.begin(), deaths.end());
+    }
+
+    void loadSparse(const Grid &grid)
+    {
+        for (int row = 0; row < numRows; ++row)
+        {
+            const uint8_t *cells = grid.cells[row];
+            for (int col = 0; col < numCols; ++col)
+            {
+                if (cells[col])
+                {
+                    birth(keyOf(row, col));
+                    changed.push_back(keyOf(row, col));
+                }
+            }
+        }
+    }
+
+    void clearSparse()
+    {
+        live.clear();
+        counts.clear();
+        changed.clear();
+    }
+
+    void switchToDense()
+    {
+        Grid board = initGrid(0, 0, 0);
+        exportCells(board);
+        dense.importCells(board);
+        clearSparse();
+        denseMode = true;
+        generationsSinceCheck = 0;
+    }
+
+    void switchToSparse()
+    {
+        Grid board = initGrid(0, 0, 0);
+        dense.exportCells(board);
+        dense.reset(0, 0);
+        denseMode = false;
+        loadSparse(board);
+    }
+
+    int numRows = 0;
+    int numCols = 0;
+    std::unordered_set<uint64_t> live;
+    std::unordered_map<uint64_t, uint8_t> counts; // Live neighbours, only for cells with at least one
+    std::vector<uint64_t> changed;                // Births and deaths of the last generation
+    std::vector<uint64_t> candidates;
+    std::vector<uint64_t> births;
+    std::vector<uint64_t> deaths;
+
+    bool denseMode = false;
+    int generationsSinceCheck = 0;
+    BlockEngine dense;
+};